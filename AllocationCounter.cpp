@@ -0,0 +1,74 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::uint64_t> total(0);
+static std::atomic<std::uint64_t> ticks(0);
+static thread_local std::uint64_t perThread = 0;
+
+#ifdef RWM_COUNT_ALLOCATIONS
+
+static void *countedAlloc(std::size_t size) {
+    perThread++;
+    total.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new(std::size_t size) {
+    void *p = countedAlloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size) {
+    void *p = countedAlloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+bool allocationCountingEnabled() {
+    return true;
+}
+
+#else
+
+bool allocationCountingEnabled() {
+    return false;
+}
+
+#endif
+
+std::uint64_t threadAllocations() {
+    return perThread;
+}
+
+std::uint64_t totalAllocations() {
+    return total.load(std::memory_order_relaxed);
+}
+
+std::uint64_t allocatingTicks() {
+    return ticks.load(std::memory_order_relaxed);
+}
+
+TickAllocationCheck::~TickAllocationCheck() {
+    if (perThread != start_)
+        ticks.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,33 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// Heap allocation accounting. In builds configured with
+// -DRWM_COUNT_ALLOCATIONS=ON the global operator new counts every
+// allocation, and stepGame() and advanceEnemies() check that a tick makes
+// none. Otherwise nothing is counted and every count stays 0.
+
+// Whether this build counts allocations.
+bool allocationCountingEnabled();
+
+// Allocations made so far by the calling thread, and by all threads.
+std::uint64_t threadAllocations();
+std::uint64_t totalAllocations();
+
+// Ticks that allocated on the thread that ran them.
+std::uint64_t allocatingTicks();
+
+// Counts the ticks that allocate: put one on the stack for the duration of
+// a tick. Only the constructing thread's allocations are considered, so
+// other games running on other threads do not interfere.
+class TickAllocationCheck {
+public:
+    TickAllocationCheck() : start_(threadAllocations()) {}
+    ~TickAllocationCheck();
+
+private:
+    std::uint64_t start_;
+};
+
+#endif  // ALLOCATIONCOUNTER_H
@@ -0,0 +1,404 @@
+// Micro-benchmarks for the core engine functions.
+//
+// Each case runs at several map sizes and entity counts and prints one CSV
+// row: name, rows, cols, enemies, powerups, iterations, ns_per_op. Rows are
+// stable across runs, so two outputs can be joined on the first five
+// columns to spot regressions.
+#include "ChaseKernel.h"
+#include "EnemyUpdate.h"
+#include "Game.h"
+#include "LevelGenerator.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "Rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Discards everything written to it; stands in for the terminal.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// Sends std::cout to a NullBuffer for as long as it lives.
+class SilenceCout {
+public:
+    SilenceCout() : old_(std::cout.rdbuf(&sink_)) {}
+    ~SilenceCout() { std::cout.rdbuf(old_); }
+
+private:
+    NullBuffer sink_;
+    std::streambuf *old_;
+};
+
+// Keeps the optimizer from dropping a computed value.
+static volatile long long sink;
+
+// Cases whose results failed a correctness check; makes the exit status 1.
+static int failures = 0;
+
+struct Case {
+    int rows, cols;
+    int enemies, powerups;  // Entity counts after padding the generated level.
+    bool extraEntities;     // More entities than the level generates.
+};
+
+struct Settings {
+    double minSeconds;   // Time each case runs for at least.
+    std::string filter;  // Only run benchmarks whose name contains this.
+    std::string savePath;
+};
+
+// Level-1 map of the given size with extra enemies (from spawnEnemies(),
+// as swarm levels get them) and powerups scattered over free floor until
+// the requested counts are reached.
+static Game makeGame(const Case &c, std::uint64_t seed) {
+    Game game;
+    game.rng.seed(seed);
+    initLevel(game, 1, c.rows, c.cols);
+    spawnEnemies(game, std::max(0, c.enemies - static_cast<int>(game.enemies.size())));
+    Rng rng(seed ^ 0x9e3779b97f4a7c15ULL);
+    int attempts = c.rows * c.cols * 4;
+    while (static_cast<int>(game.powerups.size()) < c.powerups && attempts-- > 0) {
+        Position p = {static_cast<int>(rng.below(c.rows)), static_cast<int>(rng.below(c.cols))};
+        if (!isValidMove(p, game.grid) || game.grid.at(p) == Tile::Exit ||
+            (p.x == game.player.pos.x && p.y == game.player.pos.y) ||
+            game.occupancy.powerupAt(p) >= 0 || game.occupancy.enemiesAt(p) > 0)
+            continue;
+        game.powerups.push_back(p);
+        game.occupancy.setPowerup(p, static_cast<int>(game.powerups.size()) - 1);
+    }
+    prepareTickScratch(game);
+    return game;
+}
+
+// Run body(iterations) with growing batches until it has taken minSeconds,
+// then return the time per operation in nanoseconds.
+template <typename Body>
+static double measure(const Settings &settings, long long &iterations, Body body) {
+    using Clock = std::chrono::steady_clock;
+    body(1);  // Warm caches and lazily built state.
+    long long batch = 1;
+    iterations = 0;
+    double seconds = 0.0;
+    while (seconds < settings.minSeconds) {
+        Clock::time_point start = Clock::now();
+        body(batch);
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        iterations += batch;
+        if (batch < (1LL << 30))
+            batch *= 2;
+    }
+    return seconds * 1e9 / static_cast<double>(iterations);
+}
+
+static void report(std::ostream &out, const char *name, const Case &c, const Game &game,
+                   long long iterations, double nsPerOp) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "%s,%d,%d,%zu,%zu,%lld,%.1f\n", name, c.rows, c.cols,
+                  game.enemies.size(), game.powerups.size(), iterations, nsPerOp);
+    out << line;
+    out.flush();
+}
+
+static bool wanted(const Settings &settings, const char *name) {
+    return settings.filter.empty() || std::strstr(name, settings.filter.c_str()) != nullptr;
+}
+
+static void benchInitLevel(std::ostream &out, const Settings &settings, const Case &c) {
+    Game game = makeGame(c, 1);
+    long long iterations;
+    double ns = measure(settings, iterations, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            game.rng.seed(static_cast<std::uint64_t>(i));
+            initLevel(game, 1, c.rows, c.cols);
+        }
+        sink = game.grid.size();
+    });
+    report(out, "initLevel", c, game, iterations, ns);
+}
+
+static void benchCarveGuaranteedPath(std::ostream &out, const Settings &settings, const Case &c) {
+    Game game = makeGame(c, 1);
+    long long iterations;
+    double ns = measure(settings, iterations, [&](long long n) {
+        for (long long i = 0; i < n; i++)
+            carveGuaranteedPath(game);
+        sink = game.grid.size();
+    });
+    report(out, "carveGuaranteedPath", c, game, iterations, ns);
+}
+
+// One iteration asks calculateEnemyMove() for every enemy, as moveEnemies()
+// does in greedy pursuit, without applying the moves.
+static void benchCalculateEnemyMove(std::ostream &out, const Settings &settings, const Case &c) {
+    Game game = makeGame(c, 1);
+    long long iterations;
+    double ns = measure(settings, iterations, [&](long long n) {
+        long long total = 0;
+        for (long long i = 0; i < n; i++) {
+            for (std::size_t e = 0; e < game.enemies.size(); e++) {
+                Position next = calculateEnemyMove(game.enemies[e], game.player.pos, game.grid);
+                total += next.x + next.y;
+            }
+        }
+        sink = total;
+    });
+    report(out, "calculateEnemyMove", c, game, iterations, ns);
+}
+
+// One iteration runs the batch chase kernel over every enemy, as a greedy
+// tick does. The vector path is first checked against the scalar reference
+// on the same swarm.
+static void benchChaseStep(std::ostream &out, const Settings &settings, const Case &c) {
+    Game game = makeGame(c, 1);
+    std::size_t n = game.enemies.size();
+    std::size_t mismatches = verifyChaseStep(game.grid, game.player.pos, game.enemies.xs(),
+                                             game.enemies.ys(), n);
+    if (mismatches > 0) {
+        std::cerr << "chaseStep differs from chaseStepScalar for " << mismatches << " of " << n
+                  << " enemies at " << c.rows << "x" << c.cols << std::endl;
+        failures++;
+    }
+    EnemyList next;
+    next.resize(n);
+    long long iterations;
+    double ns = measure(settings, iterations, [&](long long count) {
+        for (long long i = 0; i < count; i++)
+            chaseStep(game.grid, game.player.pos, game.enemies.xs(), game.enemies.ys(),
+                      next.xs(), next.ys(), n);
+        sink = n > 0 ? next.xs()[n - 1] : 0;
+    });
+    report(out, "chaseStep", c, game, iterations, ns);
+}
+
+// Ticks of the serial and parallel enemy updates compared before timing.
+static const int CHECK_TICKS = 16;
+
+// Run CHECK_TICKS enemy updates serially and with the parallel updater in
+// both pursuit modes; returns the number of enemies whose positions or
+// cell counts differ at the end.
+static std::size_t checkParallelUpdate(const Game &start, ThreadPool &pool) {
+    std::size_t mismatches = 0;
+    const PursuitMode modes[] = {PursuitMode::Greedy, PursuitMode::FlowField};
+    for (PursuitMode mode : modes) {
+        Game serial = start;
+        Game parallel = start;
+        ParallelEnemyUpdater updater(pool);
+        serial.pursuit = mode;
+        parallel.pursuit = mode;
+        parallel.enemyUpdater = &updater;
+        prepareTickScratch(serial);
+        prepareTickScratch(parallel);
+        for (int t = 0; t < CHECK_TICKS; t++) {
+            moveEnemies(serial);
+            moveEnemies(parallel);
+        }
+        for (std::size_t i = 0; i < serial.enemies.size(); i++) {
+            Position a = serial.enemies[i], b = parallel.enemies[i];
+            if (a.x != b.x || a.y != b.y ||
+                serial.occupancy.enemiesAt(a) != parallel.occupancy.enemiesAt(b))
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// One iteration is one greedy moveEnemies() tick, serial or on a thread
+// pool, from the same starting swarm each time: the enemies are put back
+// with restoreSnapshot(), which costs O(enemies) in both variants. The
+// parallel update is first checked against the serial one.
+static void benchEnemyUpdate(std::ostream &out, const Settings &settings, const Case &c,
+                             bool parallel) {
+    Game game = makeGame(c, 1);
+    ThreadPool pool;
+    ParallelEnemyUpdater updater(pool);
+    const char *name = parallel ? "enemyUpdateParallel" : "enemyUpdate";
+    if (parallel) {
+        std::size_t mismatches = checkParallelUpdate(game, pool);
+        if (mismatches > 0) {
+            std::cerr << "Parallel enemy update differs from the serial one for " << mismatches
+                      << " enemies at " << c.rows << "x" << c.cols << std::endl;
+            failures++;
+        }
+        game.enemyUpdater = &updater;
+        prepareTickScratch(game);
+    }
+    GameSnapshot start;
+    takeSnapshot(game, start);
+    long long iterations;
+    double ns = measure(settings, iterations, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            restoreSnapshot(game, start);
+            moveEnemies(game);
+        }
+        sink = game.enemies.size() > 0 ? game.enemies.xs()[0] : 0;
+    });
+    report(out, name, c, game, iterations, ns);
+}
+
+static void benchEnemyUpdateSerial(std::ostream &out, const Settings &settings, const Case &c) {
+    benchEnemyUpdate(out, settings, c, false);
+}
+
+static void benchEnemyUpdateParallel(std::ostream &out, const Settings &settings,
+                                     const Case &c) {
+    benchEnemyUpdate(out, settings, c, true);
+}
+
+// Probes a fixed sequence of cells, a quarter of them holding a powerup.
+// A collected powerup is put straight back so every iteration sees the
+// same map.
+static void benchCheckAndCollectPowerup(std::ostream &out, const Settings &settings,
+                                        const Case &c) {
+    Game game = makeGame(c, 1);
+    std::vector<Position> probes;
+    Rng rng(7);
+    for (int i = 0; i < 1024; i++) {
+        if (i % 4 == 0 && !game.powerups.empty())
+            probes.push_back(game.powerups[rng.below(static_cast<std::uint32_t>(game.powerups.size()))]);
+        else
+            probes.push_back({static_cast<int>(rng.below(c.rows)), static_cast<int>(rng.below(c.cols))});
+    }
+    long long iterations;
+    double ns = measure(settings, iterations, [&](long long n) {
+        long long hits = 0;
+        for (long long i = 0; i < n; i++) {
+            const Position &p = probes[static_cast<std::size_t>(i) & 1023];
+            if (checkAndCollectPowerup(game, p)) {
+                hits++;
+                game.powerups.push_back(p);
+                game.occupancy.setPowerup(p, static_cast<int>(game.powerups.size()) - 1);
+            }
+        }
+        sink = hits;
+    });
+    report(out, "checkAndCollectPowerup", c, game, iterations, ns);
+}
+
+// Full-screen draw into a discarded std::cout; the viewport is whatever
+// terminalSize() reports (24x80 when not run on a terminal).
+static void benchPrintGrid(std::ostream &out, const Settings &settings, const Case &c) {
+    Game game = makeGame(c, 1);
+    long long iterations;
+    double ns;
+    {
+        SilenceCout silence;
+        ns = measure(settings, iterations, [&](long long n) {
+            for (long long i = 0; i < n; i++)
+                printGrid(game);
+        });
+    }
+    report(out, "printGrid", c, game, iterations, ns);
+}
+
+// saveGame() followed by loadGame() of the same text file.
+static void benchSaveLoad(std::ostream &out, const Settings &settings, const Case &c) {
+    Game game = makeGame(c, 1);
+    Game loaded;
+    long long iterations;
+    double ns;
+    bool ok = true;
+    {
+        SilenceCout silence;
+        ns = measure(settings, iterations, [&](long long n) {
+            for (long long i = 0; i < n; i++) {
+                saveGame(game, settings.savePath);
+                ok = loadGame(loaded, settings.savePath) && ok;
+            }
+        });
+    }
+    std::remove(settings.savePath.c_str());
+    if (!ok) {
+        std::cerr << "saveGame/loadGame round trip failed at " << c.rows << "x" << c.cols
+                  << std::endl;
+        failures++;
+    }
+    report(out, "saveLoadRoundTrip", c, game, iterations, ns);
+}
+
+static void usage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --filter NAME    only run benchmarks whose name contains NAME\n"
+              << "  --min-time S     seconds to run each case for (default 0.2)\n"
+              << "  --out FILE       write the CSV to FILE instead of standard output\n";
+}
+
+int main(int argc, char *argv[]) {
+    Settings settings;
+    settings.minSeconds = 0.2;
+    settings.savePath = "bench_savegame.txt";
+    std::string outPath;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            settings.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            settings.minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath);
+        if (!file) {
+            std::cerr << "Cannot write " << outPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = outPath.empty() ? std::cout : file;
+
+    const Case CASES[] = {
+        {20, 20, 3, 2, false},  // The default game.
+        {20, 20, 32, 32, true},
+        {128, 128, 3, 2, false},
+        {128, 128, 256, 256, true},
+        {1024, 1024, 3, 2, false},
+        {1024, 1024, 4096, 4096, true},
+        {1024, 1024, 65536, 0, true},  // A large swarm.
+    };
+    typedef void (*Bench)(std::ostream &, const Settings &, const Case &);
+    const struct {
+        const char *name;
+        Bench run;
+        bool usesEntities;  // Cost depends on the entity counts, not just the size.
+    } BENCHES[] = {
+        {"initLevel", benchInitLevel, false},
+        {"carveGuaranteedPath", benchCarveGuaranteedPath, false},
+        {"calculateEnemyMove", benchCalculateEnemyMove, true},
+        {"chaseStep", benchChaseStep, true},
+        {"enemyUpdate", benchEnemyUpdateSerial, true},
+        {"enemyUpdateParallel", benchEnemyUpdateParallel, true},
+        {"checkAndCollectPowerup", benchCheckAndCollectPowerup, true},
+        {"printGrid", benchPrintGrid, true},
+        {"saveLoadRoundTrip", benchSaveLoad, true},
+    };
+
+    if (wanted(settings, "chaseStep"))
+        std::cerr << "chaseStep uses the " << (chaseStepIsVectorized() ? "AVX2" : "scalar")
+                  << " path." << std::endl;
+    out << "name,rows,cols,enemies,powerups,iterations,ns_per_op\n";
+    for (const auto &bench : BENCHES) {
+        if (!wanted(settings, bench.name))
+            continue;
+        for (const Case &c : CASES) {
+            if (bench.usesEntities || !c.extraEntities)
+                bench.run(out, settings, c);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
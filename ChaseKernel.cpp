@@ -0,0 +1,131 @@
+#include "ChaseKernel.h"
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define RWM_HAVE_AVX2_KERNEL 1
+    #include <immintrin.h>
+#endif
+
+// Whether (x, y) is inside the grid and not a wall.
+static inline bool openCell(const Grid &grid, int x, int y) {
+    return x >= 0 && x < grid.rows() && y >= 0 && y < grid.cols() && !grid.isBlocked(x, y);
+}
+
+void chaseStepScalar(const Grid &grid, const Position &player,
+                     const int *xs, const int *ys, int *outX, int *outY, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        int dx = player.x - xs[i];
+        int dy = player.y - ys[i];
+        int sx = (dx > 0) - (dx < 0);
+        int sy = (dy > 0) - (dy < 0);
+        bool useX = (dx < 0 ? -dx : dx) >= (dy < 0 ? -dy : dy);
+        int nx = xs[i] + (useX ? sx : 0);
+        int ny = ys[i] + (useX ? 0 : sy);
+        if (!openCell(grid, nx, ny)) {
+            nx = xs[i];
+            ny = ys[i] + sy;
+            if (!openCell(grid, nx, ny))
+                ny = ys[i];
+        }
+        outX[i] = nx;
+        outY[i] = ny;
+    }
+}
+
+#ifdef RWM_HAVE_AVX2_KERNEL
+
+// Lane mask of cells that are inside the grid and not walls. Out-of-bounds
+// lanes skip the gather; in-bounds lanes read 4 bytes of the padded blocked
+// buffer and keep the low one.
+__attribute__((target("avx2")))
+static inline __m256i openCells8(const unsigned char *blocked, __m256i x, __m256i y,
+                                 __m256i rows, __m256i cols) {
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    __m256i inside = _mm256_and_si256(
+        _mm256_and_si256(_mm256_cmpgt_epi32(x, minusOne), _mm256_cmpgt_epi32(rows, x)),
+        _mm256_and_si256(_mm256_cmpgt_epi32(y, minusOne), _mm256_cmpgt_epi32(cols, y)));
+    __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(x, cols), y);
+    __m256i bytes = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(),
+                                                reinterpret_cast<const int *>(blocked),
+                                                index, inside, 1);
+    __m256i wall = _mm256_and_si256(bytes, _mm256_set1_epi32(0xFF));
+    __m256i open = _mm256_cmpeq_epi32(wall, _mm256_setzero_si256());
+    return _mm256_and_si256(inside, open);
+}
+
+__attribute__((target("avx2")))
+static std::size_t chaseStepAvx2(const Grid &grid, const Position &player,
+                                 const int *xs, const int *ys, int *outX, int *outY,
+                                 std::size_t n) {
+    const unsigned char *blocked = grid.blockedData();
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i px = _mm256_set1_epi32(player.x);
+    const __m256i py = _mm256_set1_epi32(player.y);
+    const __m256i rows = _mm256_set1_epi32(grid.rows());
+    const __m256i cols = _mm256_set1_epi32(grid.cols());
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i ex = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(xs + i));
+        __m256i ey = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ys + i));
+        __m256i dx = _mm256_sub_epi32(px, ex);
+        __m256i dy = _mm256_sub_epi32(py, ey);
+        // sign(d) = (d > 0) - (d < 0); comparisons yield -1 for true.
+        __m256i sx = _mm256_sub_epi32(_mm256_cmpgt_epi32(zero, dx), _mm256_cmpgt_epi32(dx, zero));
+        __m256i sy = _mm256_sub_epi32(_mm256_cmpgt_epi32(zero, dy), _mm256_cmpgt_epi32(dy, zero));
+        // Step along x when |dx| >= |dy|, i.e. unless |dy| > |dx|.
+        __m256i useY = _mm256_cmpgt_epi32(_mm256_abs_epi32(dy), _mm256_abs_epi32(dx));
+
+        __m256i firstX = _mm256_add_epi32(ex, _mm256_andnot_si256(useY, sx));
+        __m256i firstY = _mm256_add_epi32(ey, _mm256_and_si256(useY, sy));
+        __m256i firstOpen = openCells8(blocked, firstX, firstY, rows, cols);
+
+        __m256i fallbackY = _mm256_add_epi32(ey, sy);
+        __m256i fallbackOpen = openCells8(blocked, ex, fallbackY, rows, cols);
+
+        __m256i nx = _mm256_blendv_epi8(ex, firstX, firstOpen);
+        __m256i ny = _mm256_blendv_epi8(_mm256_blendv_epi8(ey, fallbackY, fallbackOpen),
+                                        firstY, firstOpen);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(outX + i), nx);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(outY + i), ny);
+    }
+    return i;
+}
+
+static bool cpuHasAvx2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+
+#endif  // RWM_HAVE_AVX2_KERNEL
+
+void chaseStep(const Grid &grid, const Position &player,
+               const int *xs, const int *ys, int *outX, int *outY, std::size_t n) {
+    std::size_t done = 0;
+#ifdef RWM_HAVE_AVX2_KERNEL
+    if (cpuHasAvx2())
+        done = chaseStepAvx2(grid, player, xs, ys, outX, outY, n);
+#endif
+    chaseStepScalar(grid, player, xs + done, ys + done, outX + done, outY + done, n - done);
+}
+
+bool chaseStepIsVectorized() {
+#ifdef RWM_HAVE_AVX2_KERNEL
+    return cpuHasAvx2();
+#else
+    return false;
+#endif
+}
+
+std::size_t verifyChaseStep(const Grid &grid, const Position &player,
+                            const int *xs, const int *ys, std::size_t n) {
+    std::vector<int> ax(n), ay(n), bx(n), by(n);
+    chaseStepScalar(grid, player, xs, ys, ax.data(), ay.data(), n);
+    chaseStep(grid, player, xs, ys, bx.data(), by.data(), n);
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        if (ax[i] != bx[i] || ay[i] != by[i])
+            mismatches++;
+    }
+    return mismatches;
+}
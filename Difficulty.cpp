@@ -0,0 +1,192 @@
+#include "Difficulty.h"
+#include "Solver.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+const char *policyName(Policy policy) {
+    switch (policy) {
+    case Policy::Greedy: return "greedy";
+    case Policy::Solver: return "solver";
+    default:             return "random";
+    }
+}
+
+bool parsePolicy(const std::string &name, Policy &policy) {
+    if (name == "random")
+        policy = Policy::Random;
+    else if (name == "greedy")
+        policy = Policy::Greedy;
+    else if (name == "solver")
+        policy = Policy::Solver;
+    else
+        return false;
+    return true;
+}
+
+EstimateOptions::EstimateOptions()
+    : level(1), games(1000), baseSeed(1), policy(Policy::Greedy),
+      pursuit(PursuitMode::Greedy), rows(DEFAULT_ROWS), cols(DEFAULT_COLS),
+      maxMoves(0), threads(0) {}
+
+namespace {
+
+// z for a two-sided 95% interval.
+const double Z95 = 1.96;
+
+struct GameResult {
+    bool won;
+    bool timedOut;
+    int score;
+    int moves;
+};
+
+// Stream for the random policy, kept apart from the level generator's.
+const std::uint64_t POLICY_STREAM = 0x5eedf00dULL;
+
+Action actionToward(const Position &from, const Position &to) {
+    if (to.x < from.x) return Action::Up;
+    if (to.x > from.x) return Action::Down;
+    if (to.y < from.y) return Action::Left;
+    if (to.y > from.y) return Action::Right;
+    return Action::None;
+}
+
+GameResult playGame(const EstimateOptions &options, int index) {
+    Game game;
+    game.pursuit = options.pursuit;
+    game.rng.seed(options.baseSeed + static_cast<std::uint64_t>(index));
+    initLevel(game, options.level, options.rows, options.cols);
+    int maxMoves = options.maxMoves > 0 ? options.maxMoves : 4 * game.grid.size();
+
+    Rng rng;
+    rng.seed(options.baseSeed + static_cast<std::uint64_t>(index), POLICY_STREAM);
+    FlowField toExit;
+    toExit.build(game.grid, game.exitPos);
+    std::vector<Action> plan;
+    if (options.policy == Policy::Solver) {
+        SolverResult result = solveLevel(game);
+        if (result.solved)
+            plan = result.actions;
+    }
+
+    GameResult result = {false, false, 0, 0};
+    std::size_t planned = 0;
+    int outcome = STEP_IGNORED;
+    int turn = 0;
+    for (; turn < maxMoves; turn++) {
+        Action action;
+        if (planned < plan.size()) {
+            action = plan[planned++];
+        } else if (options.policy == Policy::Random) {
+            static const Action ACTIONS[4] = {Action::Up, Action::Down, Action::Left, Action::Right};
+            static const int DX[4] = {-1, 1, 0, 0};
+            static const int DY[4] = {0, 0, -1, 1};
+            Action open[4];
+            int count = 0;
+            for (int a = 0; a < 4; a++) {
+                Position next = {game.player.pos.x + DX[a], game.player.pos.y + DY[a]};
+                if (isValidMove(next, game.grid))
+                    open[count++] = ACTIONS[a];
+            }
+            if (count == 0)
+                break;
+            action = open[rng.below(count)];
+        } else {
+            action = actionToward(game.player.pos, toExit.step(game.player.pos));
+            if (action == Action::None)
+                break;  // Walled off from the exit.
+        }
+        outcome = stepGame(game, action);
+        if (outcome & (STEP_CAUGHT | STEP_EXIT))
+            break;
+    }
+    result.won = (outcome & STEP_EXIT) && !(outcome & STEP_CAUGHT);
+    // A policy that runs out of moves to try is stuck, not out of time.
+    result.timedOut = turn == maxMoves;
+    result.score = game.score;
+    result.moves = game.totalMoves;
+    return result;
+}
+
+// Mean and normal-approximation interval of a sample, kept within the
+// sample's range (the mean cannot lie outside it).
+Interval meanInterval(const std::vector<double> &sample) {
+    Interval interval = {0.0, 0.0, 0.0};
+    std::size_t n = sample.size();
+    if (n == 0)
+        return interval;
+    double sum = 0.0;
+    double lowest = sample[0], highest = sample[0];
+    for (double v : sample) {
+        sum += v;
+        lowest = std::min(lowest, v);
+        highest = std::max(highest, v);
+    }
+    double mean = sum / n;
+    double halfWidth = 0.0;
+    if (n > 1) {
+        double squares = 0.0;
+        for (double v : sample)
+            squares += (v - mean) * (v - mean);
+        halfWidth = Z95 * std::sqrt(squares / (n - 1) / n);
+    }
+    interval.mean = mean;
+    interval.low = std::max(lowest, mean - halfWidth);
+    interval.high = std::min(highest, mean + halfWidth);
+    return interval;
+}
+
+// Wilson score interval for a proportion. It lies inside [0, 1] in exact
+// arithmetic; the bounds are clamped because rounding can put them a hair
+// outside when every game is won or lost.
+Interval wilsonInterval(int successes, int n) {
+    Interval interval = {0.0, 0.0, 0.0};
+    if (n == 0)
+        return interval;
+    double p = static_cast<double>(successes) / n;
+    double z2 = Z95 * Z95;
+    double denom = 1.0 + z2 / n;
+    double center = (p + z2 / (2.0 * n)) / denom;
+    double halfWidth = Z95 * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denom;
+    interval.mean = p;
+    interval.low = std::max(0.0, center - halfWidth);
+    interval.high = std::min(1.0, center + halfWidth);
+    return interval;
+}
+
+}  // namespace
+
+Estimate estimateDifficulty(const EstimateOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    int games = options.games > 0 ? options.games : 0;
+    std::vector<GameResult> results(games);
+    ThreadPool pool(options.threads);
+    // Games vary from a handful of moves to thousands, hence stealing.
+    pool.parallelForStealing(results.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++)
+            results[i] = playGame(options, static_cast<int>(i));
+    });
+
+    Estimate estimate;
+    estimate.games = games;
+    estimate.wins = 0;
+    estimate.timeouts = 0;
+    std::vector<double> scores, moves;
+    scores.reserve(games);
+    moves.reserve(games);
+    for (const GameResult &r : results) {
+        estimate.wins += r.won ? 1 : 0;
+        estimate.timeouts += r.timedOut ? 1 : 0;
+        scores.push_back(r.score);
+        moves.push_back(r.moves);
+    }
+    estimate.winRate = wilsonInterval(estimate.wins, games);
+    estimate.score = meanInterval(scores);
+    estimate.moves = meanInterval(moves);
+    estimate.threads = pool.size();
+    estimate.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return estimate;
+}
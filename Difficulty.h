@@ -0,0 +1,59 @@
+#ifndef DIFFICULTY_H
+#define DIFFICULTY_H
+
+#include <cstdint>
+#include <string>
+#include "Game.h"
+
+// How a simulated player chooses its moves.
+enum class Policy {
+    Random,  // Uniformly random open neighbour.
+    Greedy,  // Shortest maze path to the exit, ignoring enemies and powerups.
+    Solver   // Follow solveLevel()'s plan; greedy if it finds none.
+};
+
+const char *policyName(Policy policy);
+
+// Parse "random", "greedy" or "solver".
+bool parsePolicy(const std::string &name, Policy &policy);
+
+// Settings for estimateDifficulty().
+struct EstimateOptions {
+    int level;               // Level to generate.
+    int games;               // Games to simulate; game i uses seed baseSeed + i.
+    std::uint64_t baseSeed;
+    Policy policy;
+    PursuitMode pursuit;
+    int rows, cols;          // Maze size.
+    int maxMoves;            // Moves before a game counts as lost; 0 = 4 per cell.
+    int threads;             // Worker threads (0 = one per hardware thread).
+
+    EstimateOptions();
+};
+
+// A sample mean and its 95% confidence interval.
+struct Interval {
+    double mean;
+    double low, high;
+};
+
+// Aggregate results of a batch of simulated games.
+struct Estimate {
+    int games;
+    int wins;
+    int timeouts;            // Games stopped at maxMoves.
+    Interval winRate;        // Fraction won, with a Wilson score interval.
+    Interval score;
+    Interval moves;          // Game::totalMoves at the end of each game.
+    int threads;
+    double seconds;
+
+    double gamesPerSecond() const { return seconds > 0 ? games / seconds : 0.0; }
+};
+
+// Play options.games independent games of one level with no I/O, spread
+// over a work-stealing thread pool. Results do not depend on the number of
+// threads.
+Estimate estimateDifficulty(const EstimateOptions &options);
+
+#endif  // DIFFICULTY_H
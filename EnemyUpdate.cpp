@@ -0,0 +1,48 @@
+#include "EnemyUpdate.h"
+#include "ChaseKernel.h"
+#include "Game.h"
+#include "ThreadPool.h"
+
+ParallelEnemyUpdater::ParallelEnemyUpdater(ThreadPool &pool) : pool_(pool) {}
+
+void ParallelEnemyUpdater::reserve(const Game &game) {
+    next_.resize(game.enemies.size());
+}
+
+void ParallelEnemyUpdater::update(Game &game) {
+    const Grid &grid = game.grid;
+    const Position player = game.player.pos;
+    const std::size_t n = game.enemies.size();
+    next_.resize(n);
+    const int *xs = game.enemies.xs();
+    const int *ys = game.enemies.ys();
+    int *nx = next_.xs();
+    int *ny = next_.ys();
+
+    // Targets from the old positions.
+    bool flow = game.pursuit == PursuitMode::FlowField;
+    if (flow)
+        game.flowField.build(grid, player);
+    const FlowField &field = game.flowField;
+    pool_.parallelFor(n, [&](std::size_t begin, std::size_t end) {
+        if (flow) {
+            for (std::size_t i = begin; i < end; i++) {
+                Position pos = {xs[i], ys[i]};
+                Position to = field.distance(pos) > 0 ? field.step(pos)
+                                                      : calculateEnemyMove(pos, player, grid);
+                nx[i] = to.x;
+                ny[i] = to.y;
+            }
+        } else {
+            chaseStep(grid, player, xs + begin, ys + begin, nx + begin, ny + begin, end - begin);
+        }
+    });
+
+    // Occupancy counters are shared between cells' leavers and arrivals, so
+    // they are updated in one serial pass over the enemies that moved.
+    for (std::size_t i = 0; i < n; i++) {
+        if (nx[i] != xs[i] || ny[i] != ys[i])
+            game.occupancy.moveEnemy(Position{xs[i], ys[i]}, Position{nx[i], ny[i]});
+    }
+    std::swap(game.enemies, next_);
+}
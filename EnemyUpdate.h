@@ -0,0 +1,31 @@
+#ifndef ENEMYUPDATE_H
+#define ENEMYUPDATE_H
+
+#include "Entity.h"
+
+struct Game;
+class ThreadPool;
+
+// Multi-threaded counterpart of moveEnemies(), with the same result: every
+// enemy's target is computed from the old positions, split across the
+// pool's threads, and then all moves are committed together. As in the
+// serial update, enemies never block each other and may share a cell, so
+// no enemy's move depends on another's and the outcome is the same for any
+// number of threads.
+class ParallelEnemyUpdater {
+public:
+    explicit ParallelEnemyUpdater(ThreadPool &pool);
+
+    // Move every enemy one step using the game's pursuit mode.
+    void update(Game &game);
+
+    // Size the buffers for the game's maze and enemies, so update() does
+    // not allocate.
+    void reserve(const Game &game);
+
+private:
+    ThreadPool &pool_;
+    EnemyList next_;  // Targets, then committed positions.
+};
+
+#endif  // ENEMYUPDATE_H
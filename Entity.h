@@ -1,6 +1,9 @@
 #ifndef ENTITY_H
 #define ENTITY_H
 
+#include <cstddef>
+#include <vector>
+
 // Structure for representing a grid coordinate.
 struct Position {
     int x, y;
@@ -33,5 +36,37 @@ public:
     virtual char getSymbol() const override;
 };
 
+// Enemy positions stored as separate packed x and y arrays rather than a
+// vector of Enemy objects, so chase kernels can process several enemies per
+// instruction. All enemies share Enemy's symbol.
+class EnemyList {
+public:
+    std::size_t size() const { return xs_.size(); }
+    bool empty() const { return xs_.empty(); }
+    void clear() { xs_.clear(); ys_.clear(); }
+    void reserve(std::size_t n) { xs_.reserve(n); ys_.reserve(n); }
+    void resize(std::size_t n) { xs_.resize(n); ys_.resize(n); }
+
+    void push_back(const Position &pos) {
+        xs_.push_back(pos.x);
+        ys_.push_back(pos.y);
+    }
+    Position operator[](std::size_t i) const { return Position{xs_[i], ys_[i]}; }
+    void set(std::size_t i, const Position &pos) {
+        xs_[i] = pos.x;
+        ys_[i] = pos.y;
+    }
+
+    // Packed coordinate arrays, size() elements each.
+    int *xs() { return xs_.data(); }
+    int *ys() { return ys_.data(); }
+    const int *xs() const { return xs_.data(); }
+    const int *ys() const { return ys_.data(); }
+
+private:
+    std::vector<int> xs_;
+    std::vector<int> ys_;
+};
+
 #endif  // ENTITY_H
 
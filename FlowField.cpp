@@ -0,0 +1,65 @@
+#include "FlowField.h"
+
+FlowField::FlowField() : rows_(0), cols_(0) {}
+
+void FlowField::build(const Grid &grid, const Position &target) {
+    rows_ = grid.rows();
+    cols_ = grid.cols();
+    dist_.assign(grid.size(), -1);
+    queue_.resize(grid.size());
+    if (!isValidMove(target, grid))
+        return;
+
+    int head = 0, tail = 0;
+    int start = grid.index(target.x, target.y);
+    dist_[start] = 0;
+    queue_[tail++] = start;
+    while (head < tail) {
+        int cell = queue_[head++];
+        int x = cell / cols_;
+        int y = cell % cols_;
+        int next = dist_[cell] + 1;
+        // Up, down, left, right.
+        if (x > 0 && dist_[cell - cols_] < 0 && !grid.isBlocked(x - 1, y)) {
+            dist_[cell - cols_] = next;
+            queue_[tail++] = cell - cols_;
+        }
+        if (x < rows_ - 1 && dist_[cell + cols_] < 0 && !grid.isBlocked(x + 1, y)) {
+            dist_[cell + cols_] = next;
+            queue_[tail++] = cell + cols_;
+        }
+        if (y > 0 && dist_[cell - 1] < 0 && !grid.isBlocked(x, y - 1)) {
+            dist_[cell - 1] = next;
+            queue_[tail++] = cell - 1;
+        }
+        if (y < cols_ - 1 && dist_[cell + 1] < 0 && !grid.isBlocked(x, y + 1)) {
+            dist_[cell + 1] = next;
+            queue_[tail++] = cell + 1;
+        }
+    }
+}
+
+void FlowField::reserve(const Grid &grid) {
+    dist_.resize(grid.size(), -1);
+    queue_.resize(grid.size());
+}
+
+Position FlowField::step(const Position &from) const {
+    int best = distance(from);
+    if (best <= 0)
+        return from;
+
+    Position next = from;
+    const Position moves[4] = {{from.x - 1, from.y}, {from.x + 1, from.y},
+                               {from.x, from.y - 1}, {from.x, from.y + 1}};
+    for (const Position &m : moves) {
+        if (!inBounds(m, rows_, cols_))
+            continue;
+        int d = distance(m);
+        if (d >= 0 && d < best) {
+            best = d;
+            next = m;
+        }
+    }
+    return next;
+}
@@ -0,0 +1,38 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <vector>
+#include "Entity.h"
+#include "Grid.h"
+
+// Breadth-first distance field toward a single target cell. One build per
+// tick serves every enemy, so pursuit costs O(cells) regardless of how
+// many enemies follow it.
+class FlowField {
+public:
+    FlowField();
+
+    // Recompute distances from every open cell to the target.
+    void build(const Grid &grid, const Position &target);
+
+    // Size the buffers for the grid ahead of time, so build() does not
+    // allocate.
+    void reserve(const Grid &grid);
+
+    // Steps to the target from pos, or -1 if it cannot be reached.
+    int distance(const Position &pos) const {
+        return dist_[pos.x * cols_ + pos.y];
+    }
+
+    // Neighbouring cell one step closer to the target; returns from itself
+    // if it is unreachable or already at the target.
+    Position step(const Position &from) const;
+
+private:
+    int rows_;
+    int cols_;
+    std::vector<int> dist_;
+    std::vector<int> queue_;  // Reused BFS queue of cell indices.
+};
+
+#endif  // FLOWFIELD_H
@@ -1,19 +1,59 @@
 #include "Game.h"
+#include "AllocationCounter.h"
 #include "Utils.h"
+#include "Renderer.h"
+#include "SaveBinary.h"
+#include "SaveWriter.h"
+#include "Snapshot.h"
+#include "Journal.h"
+#include "Replay.h"
+#include "ChaseKernel.h"
+#include "EnemyUpdate.h"
+#include "Input.h"
+#include "LevelLayout.h"
+#include "LevelPack.h"
+#include "Metrics.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 #ifdef _WIN32
     #include <windows.h>
 #endif
 
+// Moves that 'R' can take back in turn-based play.
+static const std::size_t REWIND_DEPTH = 64;
+
+// File the menu's save and load commands use.
+static const char *const SAVE_PATH = "savegame.bin";
+
+SessionOptions::SessionOptions()
+    : pursuit(PursuitMode::Greedy), seed(0), rows(DEFAULT_ROWS), cols(DEFAULT_COLS),
+      tickRate(0), frameRate(30), pack(nullptr), packStart(0) {}
+
+LoopTiming::LoopTiming()
+    : ticks(0), lateTicks(0), droppedTicks(0), totalLagMs(0.0), maxLagMs(0.0) {}
+
+void LoopTiming::record(double lagMs, double tickMs) {
+    ticks++;
+    totalLagMs += lagMs;
+    if (lagMs > maxLagMs)
+        maxLagMs = lagMs;
+    if (lagMs > tickMs / 2)
+        lateTicks++;
+}
+
 // Game constructor.
 Game::Game() : player(1, 1), score(0), moveCounter(0), totalMoves(0),
-               enemyDelay(1), level(1), gameOver(false) {}
+               enemyDelay(1), level(1), gameOver(false),
+               pursuit(PursuitMode::Greedy), lastPowerupId(-1), enemyUpdater(nullptr),
+               metrics(nullptr) {}
 
 // Save game state to a file.
 void saveGame(const Game &game, const std::string &filename) {
@@ -24,77 +64,115 @@ void saveGame(const Game &game, const std::string &filename) {
     }
     out << game.level << " " << game.score << " " << game.moveCounter << " "
         << game.totalMoves << " " << game.enemyDelay << " " << game.gameOver << "\n";
-    int rows = game.grid.size();
-    int cols = (rows > 0) ? game.grid[0].size() : 0;
+    int rows = game.grid.rows();
+    int cols = game.grid.cols();
     out << rows << " " << cols << "\n";
-    for (const auto &row : game.grid) {
-        for (char c : row)
-            out << c;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++)
+            out << tileToChar(game.grid.at(i, j));
         out << "\n";
     }
     out << game.player.pos.x << " " << game.player.pos.y << "\n";
     out << game.exitPos.x << " " << game.exitPos.y << "\n";
     out << game.enemies.size() << "\n";
-    for (const auto &enemy : game.enemies)
-        out << enemy.pos.x << " " << enemy.pos.y << "\n";
+    for (size_t i = 0; i < game.enemies.size(); i++)
+        out << game.enemies.xs()[i] << " " << game.enemies.ys()[i] << "\n";
     out << game.powerups.size() << "\n";
     for (const auto &p : game.powerups)
         out << p.x << " " << p.y << "\n";
+    out << game.rng.state() << " " << game.rng.increment() << "\n";
     out.close();
     std::cout << "Game saved to " << filename << std::endl;
 }
 
-// Load game state from a file.
+// Load game state from a file. Everything is read and checked first, so a
+// corrupt file leaves the game as it was.
 bool loadGame(Game &game, const std::string &filename) {
     std::ifstream in(filename);
     if (!in) {
         std::cout << "Error opening file for loading." << std::endl;
         return false;
     }
-    in >> game.level >> game.score >> game.moveCounter >> game.totalMoves >> game.enemyDelay;
-    int gameOverInt;
-    in >> gameOverInt;
-    game.gameOver = (gameOverInt != 0);
+    int level, score, moveCounter, totalMoves, enemyDelay, gameOverInt;
+    in >> level >> score >> moveCounter >> totalMoves >> enemyDelay >> gameOverInt;
 
     int rows, cols;
     in >> rows >> cols;
-    game.grid.assign(rows, std::vector<char>(cols, ' '));
+    if (!in || rows <= 0 || cols <= 0 || rows > MAX_MAP_DIM || cols > MAX_MAP_DIM) {
+        std::cout << "Corrupt save file." << std::endl;
+        return false;
+    }
+    Grid grid(rows, cols, Tile::Floor);
     std::string line;
     getline(in, line); // consume newline.
     for (int i = 0; i < rows; i++) {
         getline(in, line);
         for (int j = 0; j < cols && j < static_cast<int>(line.size()); j++)
-            game.grid[i][j] = line[j];
+            grid.set(i, j, charToTile(line[j]));
     }
-    in >> game.player.pos.x >> game.player.pos.y;
-    in >> game.exitPos.x >> game.exitPos.y;
+    Position player, exit;
+    in >> player.x >> player.y;
+    in >> exit.x >> exit.y;
 
-    size_t enemyCount;
+    // Entities are bounded by the cell count, so a corrupt count cannot
+    // make the loops below run away.
+    size_t cells = grid.size();
+    size_t enemyCount = 0;
     in >> enemyCount;
-    game.enemies.clear();
-    for (size_t i = 0; i < enemyCount; i++) {
-        int ex, ey;
-        in >> ex >> ey;
-        game.enemies.push_back(Enemy(ex, ey));
+    std::vector<Position> enemies;
+    for (size_t i = 0; in && enemyCount <= cells && i < enemyCount; i++) {
+        Position e;
+        in >> e.x >> e.y;
+        enemies.push_back(e);
     }
 
-    size_t powerupCount;
+    size_t powerupCount = 0;
     in >> powerupCount;
-    game.powerups.clear();
-    for (size_t i = 0; i < powerupCount; i++) {
-        int px, py;
-        in >> px >> py;
-        game.powerups.push_back({px, py});
+    std::vector<Position> powerups;
+    for (size_t i = 0; in && powerupCount <= cells && i < powerupCount; i++) {
+        Position p;
+        in >> p.x >> p.y;
+        powerups.push_back(p);
     }
 
+    // Reject truncated files and entities the grid cannot hold.
+    bool valid = !in.fail() && enemies.size() == enemyCount && powerups.size() == powerupCount;
+    valid = valid && grid.inBounds(player) && grid.inBounds(exit);
+    for (const auto &e : enemies)
+        valid = valid && grid.inBounds(e);
+    for (const auto &p : powerups)
+        valid = valid && grid.inBounds(p);
+    if (!valid) {
+        std::cout << "Corrupt save file." << std::endl;
+        return false;
+    }
+    // Generator state was added later; older saves simply lack it.
+    unsigned long long rngState, rngInc;
+    if (in >> rngState >> rngInc)
+        game.rng.setState(rngState, rngInc);
     in.close();
+
+    game.level = level;
+    game.score = score;
+    game.moveCounter = moveCounter;
+    game.totalMoves = totalMoves;
+    game.enemyDelay = enemyDelay;
+    game.gameOver = (gameOverInt != 0);
+    game.grid = std::move(grid);
+    game.player.pos = player;
+    game.exitPos = exit;
+    game.enemies.clear();
+    for (const auto &e : enemies)
+        game.enemies.push_back(e);
+    game.powerups = std::move(powerups);
+    rebuildOccupancy(game);
     std::cout << "Game loaded from " << filename << std::endl;
     return true;
 }
 
 // Enemy chase logic: choose a step toward the player.
 Position calculateEnemyMove(const Position &enemyPos, const Position &playerPos,
-                              const std::vector<std::vector<char>> &grid) {
+                              const Grid &grid) {
     Position next = enemyPos;
     int dx = playerPos.x - enemyPos.x;
     int dy = playerPos.y - enemyPos.y;
@@ -127,23 +205,106 @@ Position calculateEnemyMove(const Position &enemyPos, const Position &playerPos,
     return next;
 }
 
+// Re-index enemies and powerups after they were replaced wholesale.
+void rebuildOccupancy(Game &game) {
+    game.occupancy.rebuild(game.grid.rows(), game.grid.cols(), game.enemies, game.powerups);
+    // Every way of setting up a level ends here.
+    prepareTickScratch(game);
+}
+
+// Size the buffers a tick works in for the current maze, enemies and
+// pursuit mode, so that ticks on this level do not allocate. Sizes rather
+// than reserves, so copies of the game keep them too.
+void prepareTickScratch(Game &game) {
+    game.nextEnemies.resize(game.enemies.size());
+    if (game.pursuit == PursuitMode::FlowField)
+        game.flowField.reserve(game.grid);
+    if (game.enemyUpdater)
+        game.enemyUpdater->reserve(game);
+}
+
+// Move every enemy one step toward the player using the game's pursuit mode.
+void moveEnemies(Game &game) {
+    if (game.enemyUpdater) {
+        game.enemyUpdater->update(game);
+        return;
+    }
+    if (game.pursuit == PursuitMode::FlowField) {
+        // One BFS from the player serves all enemies. Enemies walled off
+        // from the player fall back to the greedy step.
+        game.flowField.build(game.grid, game.player.pos);
+        for (size_t i = 0; i < game.enemies.size(); i++) {
+            Position pos = game.enemies[i];
+            Position next;
+            if (game.flowField.distance(pos) > 0)
+                next = game.flowField.step(pos);
+            else
+                next = calculateEnemyMove(pos, game.player.pos, game.grid);
+            game.occupancy.moveEnemy(pos, next);
+            game.enemies.set(i, next);
+        }
+        return;
+    }
+
+    // Greedy chase: compute every move with the batch kernel, then commit.
+    // No enemy's choice depends on another's, so both levels share this.
+    size_t n = game.enemies.size();
+    game.nextEnemies.resize(n);
+    chaseStep(game.grid, game.player.pos, game.enemies.xs(), game.enemies.ys(),
+              game.nextEnemies.xs(), game.nextEnemies.ys(), n);
+    for (size_t i = 0; i < n; i++) {
+        Position from = game.enemies[i];
+        Position to = game.nextEnemies[i];
+        if (from.x != to.x || from.y != to.y)
+            game.occupancy.moveEnemy(from, to);
+    }
+    std::swap(game.enemies, game.nextEnemies);
+}
+
 // Carve a guaranteed L‑shaped corridor from start to exit so the maze is always solvable.
 void carveGuaranteedPath(Game &game) {
-    // Carve a horizontal corridor on row 1 from column 1 to COLS-2.
-    for (int j = 1; j <= COLS - 2; j++) {
-        game.grid[1][j] = ' ';
+    int rows = game.grid.rows();
+    int cols = game.grid.cols();
+    // Carve a horizontal corridor on row 1 from column 1 to cols-2.
+    for (int j = 1; j <= cols - 2; j++) {
+        game.grid.set(1, j, Tile::Floor);
     }
-    // Carve a vertical corridor in column COLS-2 from row 1 to ROWS-2.
-    for (int i = 1; i <= ROWS - 2; i++) {
-        game.grid[i][COLS - 2] = ' ';
+    // Carve a vertical corridor in column cols-2 from row 1 to rows-2.
+    for (int i = 1; i <= rows - 2; i++) {
+        game.grid.set(i, cols - 2, Tile::Floor);
     }
     // Ensure the starting cell and exit cell are set correctly.
-    game.grid[1][1] = ' ';
-    game.grid[ROWS - 2][COLS - 2] = 'E';
+    game.grid.set(1, 1, Tile::Floor);
+    game.grid.set(rows - 2, cols - 2, Tile::Exit);
 }
 
-// Initialize the maze for a given level.
-void initLevel(Game &game, int level) {
+// Generate the level from its compile-time layout if the maze is
+// Rows x Cols; returns false for other sizes and levels.
+template <int Rows, int Cols>
+static bool generateIfSize(Game &game, int level, int rows, int cols) {
+    if (rows != Rows || cols != Cols)
+        return false;
+    if (level == 1)
+        generateFixedLevel<Rows, Cols, 1>(game);
+    else if (level == 2)
+        generateFixedLevel<Rows, Cols, 2>(game);
+    else
+        return false;
+    return true;
+}
+
+// Map sizes with a level layout built at compile time (see LevelLayout.h):
+// the default maze and the square tournament sizes.
+static bool generateFixedSize(Game &game, int level, int rows, int cols) {
+    return generateIfSize<DEFAULT_ROWS, DEFAULT_COLS>(game, level, rows, cols) ||
+           generateIfSize<32, 32>(game, level, rows, cols) ||
+           generateIfSize<64, 64>(game, level, rows, cols);
+}
+
+// Generate the maze, enemies and powerups for a level, without carving the
+// guaranteed corridor; the result may not be solvable. Dimensions are
+// clamped to [MIN_MAP_DIM, MAX_MAP_DIM].
+void generateLevel(Game &game, int level, int rows, int cols) {
     game.level = level;
     game.score = 0;
     game.moveCounter = 0;
@@ -151,273 +312,713 @@ void initLevel(Game &game, int level) {
     game.gameOver = false;
     game.enemyDelay = 1;  // Enemies move after every player move.
 
-    // Generate an empty 20x20 maze.
-    game.grid.assign(ROWS, std::vector<char>(COLS, ' '));
+    // Generate an empty rows x cols maze.
+    rows = std::max(MIN_MAP_DIM, std::min(rows, MAX_MAP_DIM));
+    cols = std::max(MIN_MAP_DIM, std::min(cols, MAX_MAP_DIM));
+    if (generateFixedSize(game, level, rows, cols)) {
+        rebuildOccupancy(game);
+        return;
+    }
+    game.grid.assign(rows, cols, Tile::Floor);
 
     // Set border walls.
-    for (int i = 0; i < ROWS; i++) {
-        game.grid[i][0] = '#';
-        game.grid[i][COLS - 1] = '#';
+    for (int i = 0; i < rows; i++) {
+        game.grid.set(i, 0, Tile::WallHash);
+        game.grid.set(i, cols - 1, Tile::WallHash);
     }
-    for (int j = 0; j < COLS; j++) {
-        game.grid[0][j] = '#';
-        game.grid[ROWS - 1][j] = '#';
+    for (int j = 0; j < cols; j++) {
+        game.grid.set(0, j, Tile::WallHash);
+        game.grid.set(rows - 1, j, Tile::WallHash);
     }
 
     // Use a fill chance: Level 1 has 15% and Level 2 has 25%.
-    int fillChance = (level == 1) ? 15 : 25;
-    for (int i = 1; i < ROWS - 1; i++) {
-        for (int j = 1; j < COLS - 1; j++) {
-            if ((rand() % 100) < fillChance)
-                game.grid[i][j] = (rand() % 2 == 0) ? '#' : '@';
+    int fillChance = levelFillChance(level);
+    for (int i = 1; i < rows - 1; i++) {
+        for (int j = 1; j < cols - 1; j++) {
+            if (static_cast<int>(game.rng.below(100)) < fillChance)
+                game.grid.set(i, j, game.rng.below(2) == 0 ? Tile::WallHash : Tile::WallAt);
             else
-                game.grid[i][j] = ' ';
+                game.grid.set(i, j, Tile::Floor);
         }
     }
 
     // For Level 2, overlay extra deterministic structures.
     if (level == 2) {
         // Create a vertical wall down the middle with gaps.
-        int midCol = COLS / 2;
-        for (int i = 1; i < ROWS - 1; i++) {
-            if (i == ROWS / 3 || i == (2 * ROWS) / 3)
+        int midCol = cols / 2;
+        for (int i = 1; i < rows - 1; i++) {
+            if (i == rows / 3 || i == (2 * rows) / 3)
                 continue;
-            game.grid[i][midCol] = '#';
+            game.grid.set(i, midCol, Tile::WallHash);
         }
         // Create a horizontal wall across the middle with a gap.
-        int midRow = ROWS / 2;
-        for (int j = 1; j < COLS - 1; j++) {
-            if (j == COLS / 4)
+        int midRow = rows / 2;
+        for (int j = 1; j < cols - 1; j++) {
+            if (j == cols / 4)
                 continue;
-            game.grid[midRow][j] = '@';
+            game.grid.set(midRow, j, Tile::WallAt);
         }
     }
 
     // Set and clear the player's starting cell.
     game.player.pos = {1, 1};
-    game.grid[1][1] = ' ';
+    game.grid.set(1, 1, Tile::Floor);
 
     // Define the exit cell.
-    game.exitPos = {ROWS - 2, COLS - 2};
-    game.grid[ROWS - 2][COLS - 2] = 'E';
+    game.exitPos = {rows - 2, cols - 2};
+    game.grid.set(rows - 2, cols - 2, Tile::Exit);
 
-    // Set up enemy positions.
+    // Place enemies and powerups on cleared cells.
+    SpawnTable spawns = levelSpawns(level, rows, cols);
     game.enemies.clear();
-    if (level == 1) {
-        game.enemies.push_back(Enemy(1, COLS - 2));         // Top-right.
-        game.enemies.push_back(Enemy(ROWS / 2, 1));           // Middle-left.
-        game.enemies.push_back(Enemy(ROWS / 2, COLS - 3));      // Middle-right.
-        game.grid[1][COLS - 2] = ' ';
-        game.grid[ROWS / 2][1] = ' ';
-        game.grid[ROWS / 2][COLS - 3] = ' ';
-    } else {
-        game.enemies.push_back(Enemy(1, COLS - 2));           // Top-right.
-        game.enemies.push_back(Enemy(ROWS - 2, 1));             // Bottom-left.
-        game.enemies.push_back(Enemy(ROWS / 2, COLS - 2));        // Middle-right.
-        game.enemies.push_back(Enemy(ROWS - 2, COLS / 2));        // Bottom-middle.
-        game.enemies.push_back(Enemy(ROWS / 3, COLS / 3));        // Upper-left-ish.
-        game.grid[1][COLS - 2] = ' ';
-        game.grid[ROWS - 2][1] = ' ';
-        game.grid[ROWS / 2][COLS - 2] = ' ';
-        game.grid[ROWS - 2][COLS / 2] = ' ';
-        game.grid[ROWS / 3][COLS / 3] = ' ';
-    }
-
-    // Place powerups.
+    for (int k = 0; k < spawns.enemyCount; k++) {
+        game.enemies.push_back(spawns.enemies[k]);
+        game.grid.set(spawns.enemies[k].x, spawns.enemies[k].y, Tile::Floor);
+    }
     game.powerups.clear();
-    if (level == 1) {
-        game.powerups.push_back({ROWS / 2, COLS / 2});
-        game.powerups.push_back({3, COLS - 4});
-        game.grid[ROWS / 2][COLS / 2] = ' ';
-        game.grid[3][COLS - 4] = ' ';
-    } else {
-        game.powerups.push_back({ROWS / 2, 2});
-        game.powerups.push_back({ROWS - 3, COLS - 3});
-        game.powerups.push_back({2, 2});
-        game.grid[ROWS / 2][2] = ' ';
-        game.grid[ROWS - 3][COLS - 3] = ' ';
-        game.grid[2][2] = ' ';
+    for (int k = 0; k < spawns.powerupCount; k++) {
+        game.powerups.push_back(spawns.powerups[k]);
+        game.grid.set(spawns.powerups[k].x, spawns.powerups[k].y, Tile::Floor);
     }
 
+    rebuildOccupancy(game);
+}
+
+// Initialize the maze for a given level.
+void initLevel(Game &game, int level, int rows, int cols) {
+    generateLevel(game, level, rows, cols);
     // Guarantee a valid path from the start to the exit.
     carveGuaranteedPath(game);
 }
 
+// Remove the powerup at pos and return the index it had, or -1 if there is
+// none. The last powerup is swapped into the freed slot, so this is O(1).
+int collectPowerupAt(Game &game, const Position &pos) {
+    int id = game.occupancy.powerupAt(pos);
+    if (id < 0)
+        return -1;
+    game.occupancy.clearPowerup(pos);
+    int last = static_cast<int>(game.powerups.size()) - 1;
+    if (id != last) {
+        game.powerups[id] = game.powerups[last];
+        game.occupancy.setPowerup(game.powerups[id], id);
+    }
+    game.powerups.pop_back();
+    return id;
+}
+
 // Check and collect a powerup if the player's position matches its position.
 bool checkAndCollectPowerup(Game &game, const Position &pos) {
-    for (auto it = game.powerups.begin(); it != game.powerups.end(); ++it) {
-        if (it->x == pos.x && it->y == pos.y) {
-            game.powerups.erase(it);
-            return true;
-        }
-    }
-    return false;
+    return collectPowerupAt(game, pos) >= 0;
 }
 
-// Render the maze, along with the title and game statistics.
+// Render the part of the maze around the player that fits the terminal,
+// along with the title and game statistics.
 void printGrid(const Game &game) {
+    int termRows, termCols;
+    terminalSize(termRows, termCols);
+    Viewport view = viewportAround(game.grid, game.player.pos, termRows - SCREEN_CHROME_ROWS, termCols);
+
     std::cout << YELLOW << "=====================================" << RESET << std::endl;
     std::cout << YELLOW << "\tRun with Mind" << RESET << std::endl;
     std::cout << YELLOW << "=====================================" << RESET << std::endl;
 
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
+    for (int i = view.top; i < view.top + view.rows; i++) {
+        for (int j = view.left; j < view.left + view.cols; j++) {
             if (game.player.pos.x == i && game.player.pos.y == j) {
                 std::cout << GREEN << game.player.getSymbol() << RESET;
                 continue;
             }
-            bool enemyPrinted = false;
-            for (auto &enemy : game.enemies) {
-                if (enemy.pos.x == i && enemy.pos.y == j) {
-                    std::cout << RED << enemy.getSymbol() << RESET;
-                    enemyPrinted = true;
-                    break;
-                }
-            }
-            if (enemyPrinted)
+            Position cellPos = {i, j};
+            if (game.occupancy.enemiesAt(cellPos) > 0) {
+                std::cout << RED << 'X' << RESET;
                 continue;
-            bool powerupPrinted = false;
-            for (auto &p : game.powerups) {
-                if (p.x == i && p.y == j) {
-                    std::cout << YELLOW << "*" << RESET;
-                    powerupPrinted = true;
-                    break;
-                }
             }
-            if (powerupPrinted)
+            if (game.occupancy.powerupAt(cellPos) >= 0) {
+                std::cout << YELLOW << "*" << RESET;
                 continue;
+            }
 
-            char cell = game.grid[i][j];
-            if (cell == ' ') {
+            Tile cell = game.grid.at(i, j);
+            if (cell == Tile::Floor) {
                 if ((i + j) % 2 == 0)
                     std::cout << BG_WHITE << " " << RESET;
                 else
                     std::cout << BG_GRAY << " " << RESET;
-            } else if (cell == '#' || cell == '@') {
-                std::cout << BLUE << cell << RESET;
-            } else if (cell == 'E') {
-                std::cout << MAGENTA << cell << RESET;
+            } else if (tileBlocks(cell)) {
+                std::cout << BLUE << tileToChar(cell) << RESET;
             } else {
-                std::cout << cell;
+                std::cout << MAGENTA << tileToChar(cell) << RESET;
             }
         }
         std::cout << std::endl;
     }
     std::cout << "Score: " << game.score << "   Level: " << game.level
               << "   Moves: " << game.totalMoves << std::endl;
-    std::cout << "Controls: Move with WASD. Press 'M' for menu (save/load)." << std::endl;
+    std::cout << "Controls: WASD to move, 'R' rewind, 'M' menu (save/load), 'T' timings." << std::endl;
 }
 
-// Run a single game session.
-void runGame() {
-    int currentLevel = 1;
-    Game game;
-    initLevel(game, currentLevel);
+// Map a WASD key to a movement action.
+Action actionFromKey(char key) {
+    switch (key) {
+    case 'W': case 'w': return Action::Up;
+    case 'S': case 's': return Action::Down;
+    case 'A': case 'a': return Action::Left;
+    case 'D': case 'd': return Action::Right;
+    default:            return Action::None;
+    }
+}
 
-    while (true) {
-#ifdef _WIN32
-        system("cls");
-#else
-        system("clear");
+// Move the player one cell and collect anything there. Enemies do not move.
+int movePlayer(Game &game, Action action) {
+    // Cleared on every tick, so a tick without a move is not journalled
+    // with the powerup of an earlier one.
+    game.lastPowerupId = -1;
+    if (action == Action::None || game.gameOver)
+        return STEP_IGNORED;
+
+    int outcome = STEP_IGNORED;
+    std::uint64_t t = game.metrics ? monotonicNs() : 0;
+    Position newPos = game.player.pos;
+    if (action == Action::Up)
+        newPos.x--;
+    else if (action == Action::Down)
+        newPos.x++;
+    else if (action == Action::Left)
+        newPos.y--;
+    else
+        newPos.y++;
+
+    if (isValidMove(newPos, game.grid)) {
+        // Walking into an enemy's cell is a catch even if that enemy is
+        // about to step away (e.g. swapping places with the player).
+        bool walkedIntoEnemy = game.occupancy.enemiesAt(newPos) > 0;
+        game.player.pos = newPos;
+        game.moveCounter++;
+        game.totalMoves++;  // Increment overall moves counter.
+        outcome |= STEP_MOVED;
+        if (game.metrics)
+            t = game.metrics->lap(PHASE_PLAYER, t);
+
+        game.lastPowerupId = collectPowerupAt(game, newPos);
+        if (game.lastPowerupId >= 0) {
+            game.score += 10;
+            outcome |= STEP_POWERUP;
+        }
+        if (game.metrics)
+            game.metrics->lap(PHASE_POWERUP, t);
+        if (walkedIntoEnemy) {
+            game.gameOver = true;
+            outcome |= STEP_CAUGHT;
+        }
+    } else if (game.metrics) {
+        game.metrics->lap(PHASE_PLAYER, t);
+    }
+    return outcome;
+}
+
+// Flags for whatever is on the player's cell after everyone has moved.
+static int checkPlayerCell(Game &game) {
+    if (game.occupancy.enemiesAt(game.player.pos) > 0) {
+        game.gameOver = true;
+        return STEP_CAUGHT;
+    }
+    if (game.player.pos.x == game.exitPos.x && game.player.pos.y == game.exitPos.y)
+        return STEP_EXIT;
+    return STEP_IGNORED;
+}
+
+// moveEnemies() and the following collision check, timed if metrics are on.
+static int moveEnemiesAndCheck(Game &game, bool moveThisTurn) {
+    std::uint64_t t = game.metrics ? monotonicNs() : 0;
+    if (moveThisTurn) {
+        moveEnemies(game);
+        if (game.metrics)
+            t = game.metrics->lap(PHASE_ENEMIES, t);
+    }
+    int outcome = checkPlayerCell(game);
+    if (game.metrics)
+        game.metrics->lap(PHASE_COLLISION, t);
+    return outcome;
+}
+
+// Move every enemy one step, independent of the player.
+int advanceEnemies(Game &game) {
+#ifdef RWM_COUNT_ALLOCATIONS
+    TickAllocationCheck check;
+#endif
+    if (game.gameOver)
+        return STEP_IGNORED;
+    return moveEnemiesAndCheck(game, true);
+}
+
+// One turn: the player moves, then enemies follow every enemyDelay moves.
+int stepGame(Game &game, Action action) {
+#ifdef RWM_COUNT_ALLOCATIONS
+    TickAllocationCheck check;
 #endif
-        printGrid(game);
+    if (action == Action::None || game.gameOver)
+        return STEP_IGNORED;
+
+    int outcome = movePlayer(game, action);
+    if (outcome & STEP_CAUGHT)
+        return outcome;
 
-        if (game.player.pos.x == game.exitPos.x && game.player.pos.y == game.exitPos.y) {
-            if (game.level == 1) {
-                std::cout << "Level 1 Complete! Proceeding to Level 2..." << std::endl;
+    // Enemies move after every valid move.
+    bool enemiesMove = game.moveCounter >= game.enemyDelay;
+    if (enemiesMove)
+        game.moveCounter = 0;
+    return outcome | moveEnemiesAndCheck(game, enemiesMove);
+}
+
+// Block until the player acknowledges a message.
+static void waitForKey() {
 #ifdef _WIN32
-                system("pause");
+    system("pause");
 #else
-                std::cout << "Press any key to continue...";
-                getInputChar();
+    std::cout << "Press any key to continue...";
+    getInputChar();
 #endif
-                currentLevel = 2;
-                initLevel(game, currentLevel);
-                continue;
-            } else {
-                std::cout << "Congratulations! You completed Level 2 and won the game!" << std::endl;
+}
+
+static bool atExit(const Game &game) {
+    return game.player.pos.x == game.exitPos.x && game.player.pos.y == game.exitPos.y;
+}
+
+// Called once the player stands on the exit: move on to the next level, or
+// report the win. Returns false when the game is over.
+static bool finishLevel(Renderer &renderer, Game &game, Journal &journal,
+                        ReplayRecorder &recorder, const std::string &autosave,
+                        const SessionOptions &options) {
+    int next = game.level + 1;
+    bool more = options.pack ? game.level < options.pack->count() : game.level == 1;
+    if (!more) {
+        renderer.message("Congratulations! You completed Level " + std::to_string(game.level) +
+                         " and won the game!");
+        return false;
+    }
+    renderer.message("Level " + std::to_string(game.level) + " Complete! Proceeding to Level " +
+                     std::to_string(next) + "...");
+    // Keys typed ahead belong to the finished level.
+    inputQueue().clear();
+    waitForKey();
+    renderer.invalidate();
+    if (options.pack) {
+        if (!options.pack->load(game.level, game)) {
+            renderer.message("Level " + std::to_string(next) + " of the pack is corrupt.");
+            return false;
+        }
+    } else {
+        initLevel(game, 2, game.grid.rows(), game.grid.cols());
+    }
+    journal.begin(game, autosave);
+    recorder.keyframe(game);
+    return true;
+}
+
+// Ask for a menu command (save/load/import) with normal line input.
+// Returns whether the command replaced the game's state; a failed load
+// leaves it untouched.
+static bool runMenu(Renderer &renderer, Game &game, Journal &journal,
+                    ReplayRecorder &recorder, const std::string &autosave,
+                    SaveSlots &slots, SaveWriter &saves) {
+    TerminalSession *session = TerminalSession::current();
+    inputQueue().clear();
+    if (session)
+        session->suspend();
+    std::cout << "\nEnter command (save/load/import, or keep/restore NAME for a memory slot): ";
+    std::string command, name;
+    std::cin >> command;
+    if (command == "keep" || command == "restore")
+        std::cin >> name;
+    if (session)
+        session->resume();
+    bool replaced = false;
+    if (command == "save") {
+        // Written in the background; the game reports when it is done.
+        if (!saves.submit(game, SAVE_PATH)) {
+            std::cout << "Earlier saves are still being written. Press any key to continue...";
+            getInputChar();
+        }
+    } else if (command == "load") {
+        // Load what the last save wrote, not the file before it.
+        saves.flush();
+        if (loadGameBinary(game, SAVE_PATH)) {
+            replaced = true;
+            recorder.finish(game);
+            std::cout << "Press any key to continue...";
+        }
+        getInputChar();
+    } else if (command == "import") {
+        // Older text saves remain loadable.
+        if (loadGame(game, "savegame.txt")) {
+            replaced = true;
+            recorder.finish(game);
+            std::cout << "Press any key to continue...";
+        }
+        getInputChar();
+    } else if (command == "keep") {
+        slots.store(name, game);
+        std::cout << "Game kept in slot " << name << ". Press any key to continue...";
+        getInputChar();
+    } else if (command == "restore") {
+        if (slots.restore(name, game)) {
+            replaced = true;
+            recorder.finish(game);
+            std::cout << "Slot " << name << " restored.";
+        } else {
+            std::cout << "No slot named " << name << ".";
+        }
+        std::cout << " Press any key to continue...";
+        getInputChar();
+    }
+    // Loading replaces the whole state, so start a new snapshot. Saving and
+    // keeping leave it as it is and skip the synchronous snapshot write.
+    if (command != "save" && command != "keep")
+        journal.begin(game, autosave);
+    renderer.invalidate();
+    return replaced;
+}
+
+// Describe a finished background save.
+static std::string describeSave(const SaveResult &result) {
+    std::ostringstream text;
+    if (result.ok)
+        text << "Game saved to " << result.path << " (" << (result.bytes + 1023) / 1024
+             << " KB, " << static_cast<long>(result.ms + 0.5) << " ms).";
+    else
+        text << "Could not write " << result.path << ".";
+    return text.str();
+}
+
+// Put the newest finished save, if any, in status; returns whether one
+// finished.
+static bool takeSaveStatus(SaveWriter &saves, std::string &status) {
+    SaveResult result;
+    bool any = false;
+    while (saves.poll(result)) {
+        status = describeSave(result);
+        any = true;
+    }
+    return any;
+}
+
+// Show the timing summary so far until a key is pressed.
+static void showMetrics(Renderer &renderer, const Game &game) {
+    if (!game.metrics)
+        return;
+    std::cout << "\n";
+    game.metrics->print(std::cout);
+    waitForKey();
+    renderer.invalidate();
+}
+
+// Render one frame, timed as PHASE_RENDER.
+static void renderFrame(Renderer &renderer, const Game &game) {
+    std::uint64_t t = game.metrics ? monotonicNs() : 0;
+    renderer.render(game);
+    if (game.metrics)
+        game.metrics->lap(PHASE_RENDER, t);
+}
+
+// Turn-based play: nothing moves until the player presses a key.
+static void playTurns(Renderer &renderer, Game &game, Journal &journal,
+                      ReplayRecorder &recorder, const std::string &autosave,
+                      const SessionOptions &options, SaveSlots &slots,
+                      SaveWriter &saves) {
+    RewindBuffer history(REWIND_DEPTH);
+    // Keys are queued only inside a TerminalSession; otherwise the queue
+    // stays empty and keys are handled one per frame.
+    InputQueue &input = inputQueue();
+    std::string status;
+
+    while (true) {
+        takeSaveStatus(saves, status);
+        renderFrame(renderer, game);
+        if (!status.empty()) {
+            renderer.message(status);
+            status.clear();
+        }
+
+        if (atExit(game)) {
+            if (!finishLevel(renderer, game, journal, recorder, autosave, options))
                 break;
-            }
+            continue;
         }
 
+        // Wait for a key, then apply every key that arrived meanwhile before
+        // drawing the next frame.
+        std::uint64_t waitStart = game.metrics ? monotonicNs() : 0;
         char key = getInputChar();
-        if (key == 'm' || key == 'M') {
-            std::cout << "\nEnter command (save/load): ";
-            std::string command;
-            std::cin >> command;
-            if (command == "save") {
-                saveGame(game, "savegame.txt");
-                std::cout << "Press any key to continue...";
-                getInputChar();
-            } else if (command == "load") {
-                if (loadGame(game, "savegame.txt"))
-                    std::cout << "Press any key to continue...";
-                getInputChar();
+        if (game.metrics)
+            game.metrics->lap(PHASE_INPUT, waitStart);
+        if (key == 0 && input.eof())
+            break;  // Input closed; end the session like a quit.
+        bool finished = false;
+        bool redraw = false;
+        while (true) {
+            if (key == 'm' || key == 'M') {
+                // Moves from before a load must not be rewound into.
+                if (runMenu(renderer, game, journal, recorder, autosave, slots, saves))
+                    history.clear();
+                break;
             }
-            continue;
+            if (key == 't' || key == 'T') {
+                showMetrics(renderer, game);
+                break;
+            }
+            if (key == 'r' || key == 'R') {
+                if (history.rewind(game) > 0) {
+                    // Neither the journal nor a replay can express going back.
+                    journal.begin(game, autosave);
+                    recorder.finish(game);
+                    status = "Rewound one move.";
+                } else {
+                    status = "Nothing to rewind.";
+                }
+                break;
+            }
+
+            Action action = actionFromKey(key);
+            if (action != Action::None) {
+                history.stage(game);
+                int outcome = stepGame(game, action);
+                // Bumping into a wall changes nothing worth rewinding.
+                if (outcome != STEP_IGNORED)
+                    history.commit();
+                journal.record(game);
+                recorder.record(action, game);
+                if (outcome & STEP_POWERUP)
+                    status = "Powerup collected! Score increased.";
+                if (outcome & STEP_CAUGHT) {
+                    status = "An enemy has caught you! Game Over.";
+                    finished = true;
+                }
+                // Keys typed after reaching the exit belong to the old level.
+                redraw = (outcome & STEP_EXIT) != 0;
+            }
+            if (finished || redraw || input.empty())
+                break;
+            key = input.pop();
+        }
+        if (finished) {
+            renderFrame(renderer, game);
+            renderer.message(status);
+            break;
         }
+    }
+}
 
-        Position newPos = game.player.pos;
-        if (key == 'W' || key == 'w')
-            newPos.x--;
-        else if (key == 'S' || key == 's')
-            newPos.x++;
-        else if (key == 'A' || key == 'a')
-            newPos.y--;
-        else if (key == 'D' || key == 'd')
-            newPos.y++;
-        else
-            continue;
+// Ticks run back to back when the loop falls behind, up to this many; any
+// further backlog is dropped instead of fast-forwarding the enemies.
+static const int MAX_CATCH_UP_TICKS = 4;
 
-        if (isValidMove(newPos, game.grid)) {
-            game.player.pos = newPos;
-            game.moveCounter++;
-            game.totalMoves++;  // Increment overall moves counter.
+// How long a status message stays on screen in real-time play.
+static const int STATUS_MS = 1500;
 
-            if (checkAndCollectPowerup(game, newPos)) {
-                game.score += 10;
-                std::cout << "Powerup collected! Score increased." << std::endl;
-#ifdef _WIN32
-                system("pause");
-#else
-                std::cout << "Press any key to continue...";
-                getInputChar();
-#endif
-            }
+// Real-time play: the simulation advances tickRate times per second whether
+// or not keys are pressed, input is sampled between ticks, and frames are
+// drawn only when something changed and the frame budget allows.
+static void playRealTime(Renderer &renderer, Game &game, Journal &journal,
+                         ReplayRecorder &recorder, const std::string &autosave,
+                         const SessionOptions &options, SaveSlots &slots,
+                         SaveWriter &saves) {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration tick = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / options.tickRate));
+    const Clock::duration frame = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(options.frameRate, 1)));
+    const double tickMs = std::chrono::duration<double, std::milli>(tick).count();
+
+    InputQueue &input = inputQueue();
+    LoopTiming timing;
+    std::string status;
+    Clock::time_point statusUntil;
+    int enemyTicks = 0;
+    bool dirty = true;
+    Clock::time_point lastFrame = Clock::now() - frame;
+    Clock::time_point nextTick = Clock::now() + tick;
+
+    while (true) {
+        Clock::time_point now = Clock::now();
+        if (takeSaveStatus(saves, status)) {
+            statusUntil = now + std::chrono::milliseconds(STATUS_MS);
+            dirty = true;
+        }
+        bool ending = game.gameOver || atExit(game);
+        if (dirty && (ending || now - lastFrame >= frame)) {
+            renderFrame(renderer, game);
+            if (!status.empty())
+                renderer.message(status);
+            lastFrame = now;
+            dirty = false;
+        }
+        if (!status.empty() && now >= statusUntil) {
+            status.clear();
+            dirty = true;
+        }
+        if (game.gameOver)
+            break;
+        if (atExit(game)) {
+            if (!finishLevel(renderer, game, journal, recorder, autosave, options))
+                break;
+            enemyTicks = 0;
+            dirty = true;
+            nextTick = Clock::now() + tick;
+            continue;
         }
 
-        // Enemies move after every valid move.
-        if (game.moveCounter >= game.enemyDelay) {
-            if (game.level == 1) {
-                for (auto &enemy : game.enemies) {
-                    enemy.pos = calculateEnemyMove(enemy.pos, game.player.pos, game.grid);
-                }
-            } else {
-                std::vector<Position> newEnemyPositions;
-                for (auto &enemy : game.enemies) {
-                    Position next = calculateEnemyMove(enemy.pos, game.player.pos, game.grid);
-                    newEnemyPositions.push_back(next);
-                }
-                for (size_t i = 0; i < game.enemies.size(); i++) {
-                    game.enemies[i].pos = newEnemyPositions[i];
-                }
+        if (now < nextTick) {
+            // Sample input until the next tick, waking early for a frame
+            // that is due.
+            Clock::time_point wake = nextTick;
+            if (dirty && lastFrame + frame < wake)
+                wake = lastFrame + frame;
+            std::uint64_t waitStart = game.metrics ? monotonicNs() : 0;
+            if (input.eof()) {
+                if (input.empty())
+                    break;  // Input closed; end the session like a quit.
+                std::this_thread::sleep_until(wake);
+            } else if (wake > now) {
+                input.poll(static_cast<int>(
+                    std::chrono::ceil<std::chrono::milliseconds>(wake - now).count()));
             }
-            game.moveCounter = 0;
+            if (game.metrics)
+                game.metrics->lap(PHASE_INPUT, waitStart);
+            continue;
         }
 
-        // Check for collisions with enemies.
-        for (auto &enemy : game.enemies) {
-            if (enemy.pos.x == game.player.pos.x && enemy.pos.y == game.player.pos.y) {
-                std::cout << "An enemy has caught you! Game Over." << std::endl;
-                game.gameOver = true;
+        bool menu = false;
+        bool summary = false;
+        for (int ran = 0; now >= nextTick && ran < MAX_CATCH_UP_TICKS; ran++) {
+            timing.record(std::chrono::duration<double, std::milli>(now - nextTick).count(),
+                          tickMs);
+            nextTick += tick;
+
+            // The newest direction pressed since the previous tick wins, so
+            // held or mashed keys never build up a backlog.
+            Action action = Action::None;
+            while (!input.empty()) {
+                char key = input.pop();
+                if (key == 'm' || key == 'M')
+                    menu = true;
+                else if (key == 't' || key == 'T')
+                    summary = true;
+                else if (actionFromKey(key) != Action::None)
+                    action = actionFromKey(key);
+            }
+            if (menu || summary)
                 break;
+
+            int outcome = movePlayer(game, action);
+            bool enemiesMoved = false;
+            if (!game.gameOver && ++enemyTicks >= game.enemyDelay) {
+                enemyTicks = 0;
+                outcome |= advanceEnemies(game);
+                enemiesMoved = true;
             }
+            // Enemy steps change the state even when no flag reports them.
+            if (outcome != STEP_IGNORED || enemiesMoved) {
+                dirty = true;
+                journal.record(game);
+            }
+            if (outcome & STEP_POWERUP) {
+                status = "Powerup collected! Score increased.";
+                statusUntil = now + std::chrono::milliseconds(STATUS_MS);
+            }
+            if (outcome & STEP_CAUGHT)
+                status = "An enemy has caught you! Game Over.";
+            if (game.gameOver || atExit(game))
+                break;
         }
-        if (game.gameOver)
-            break;
+        if (menu || summary) {
+            // The clock stops while the game is paused.
+            if (menu)
+                runMenu(renderer, game, journal, recorder, autosave, slots, saves);
+            else
+                showMetrics(renderer, game);
+            dirty = true;
+            nextTick = Clock::now() + tick;
+        } else if (now >= nextTick && !game.gameOver) {
+            timing.droppedTicks += (now - nextTick) / tick + 1;
+            nextTick = now + tick;
+        }
+    }
+
+    std::cout << "Ticks: " << timing.ticks << " at " << options.tickRate << " Hz, late: "
+              << timing.lateTicks << ", dropped: " << timing.droppedTicks
+              << ", mean lag: " << timing.meanLagMs() << " ms, max lag: "
+              << timing.maxLagMs << " ms" << std::endl;
+}
+
+// Run a single game session, drawing frames through the given renderer.
+void runGame(Renderer &renderer, const SessionOptions &options) {
+    const std::string autosave = "autosave";
+    Game game;
+    bool recovered = false;
+
+    // Offer to pick up a session that ended without a clean exit.
+    if (journalExists(autosave)) {
+        std::cout << "An unfinished game was found. Recover it? (Y/N): ";
+        char answer = getInputChar();
+        std::cout << std::endl;
+        recovered = (answer == 'y' || answer == 'Y') &&
+                    recoverJournal(game, autosave) && !game.gameOver;
+        renderer.invalidate();
     }
+    game.pursuit = options.pursuit;
+    if (!recovered) {
+        game.rng.seed(options.seed);
+        if (!options.pack || !options.pack->load(options.packStart, game))
+            initLevel(game, 1, options.rows, options.cols);
+    }
+    Journal journal;
+    journal.begin(game, autosave);
+
+    // A replay can only reproduce a turn-based session generated from the
+    // seed; real-time enemy moves do not follow the recorded actions.
+    ReplayRecorder recorder;
+    if (!options.recordPath.empty() && options.tickRate > 0)
+        std::cout << "Replays are not recorded in real-time mode." << std::endl;
+    else if (!options.recordPath.empty() && options.pack)
+        std::cout << "Replays are not recorded when playing a level pack." << std::endl;
+    else if (!options.recordPath.empty() && !recovered &&
+             !recorder.begin(options.recordPath, options.seed, game))
+        std::cout << "Cannot record to " << options.recordPath << std::endl;
+
+    SaveSlots slots;
+    SaveWriter saves;
+    FrameMetrics metrics;
+    game.metrics = &metrics;
+    renderer.setMetrics(&metrics);
+    if (options.tickRate > 0)
+        playRealTime(renderer, game, journal, recorder, autosave, options, slots, saves);
+    else
+        playTurns(renderer, game, journal, recorder, autosave, options, slots, saves);
+    renderer.setMetrics(nullptr);
+    game.metrics = nullptr;
 
+    // Finish saves still being written and report the ones not yet shown.
+    saves.flush();
+    SaveResult result;
+    while (saves.poll(result))
+        std::cout << describeSave(result) << std::endl;
+
+    // The session finished normally; nothing to recover next time.
+    journal.end(true);
+    recorder.finish(game);
     std::cout << "Final Score: " << game.score << std::endl;
     std::cout << "Total Moves Made: " << game.totalMoves << std::endl;
+    metrics.print(std::cout);
 }
 
+// Run a single game session on the terminal.
+void runGame(const SessionOptions &options) {
+#ifdef _WIN32
+    TerminalRenderer renderer;
+#else
+    FrameBufferRenderer renderer;
+#endif
+    TerminalSession session;
+    runGame(renderer, options);
+}
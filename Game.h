@@ -4,12 +4,26 @@
 #include <vector>
 #include <string>
 #include "Entity.h"
+#include "Grid.h"
+#include "FlowField.h"
+#include "Occupancy.h"
+#include "Rng.h"
+
+// How enemies choose their next step.
+enum class PursuitMode {
+    Greedy,    // Step along the axis with the larger distance (calculateEnemyMove).
+    FlowField  // Step downhill on a shared BFS distance field from the player.
+};
+
+class ParallelEnemyUpdater;
+class FrameMetrics;
 
 // The Game structure holds the entire game state.
 struct Game {
-    std::vector<std::vector<char>> grid; // The maze grid.
+    Grid grid;                           // The maze grid.
     Player player;                       // The player.
-    std::vector<Enemy> enemies;          // List of enemy objects.
+    EnemyList enemies;                   // Enemy positions (structure of arrays).
+    EnemyList nextEnemies;               // Scratch for the next enemy positions.
     std::vector<Position> powerups;      // Positions of collectible items.
     Position exitPos;                    // Position of the exit.
     int score;                           // Player's score.
@@ -18,20 +32,89 @@ struct Game {
     int enemyDelay;                      // Delay between enemy moves (set to 1 in our game).
     int level;                           // Current level (e.g., 1 or 2).
     bool gameOver;                       // Flag to indicate game over.
+    PursuitMode pursuit;                 // Enemy chase strategy.
+    FlowField flowField;                 // Scratch field for PursuitMode::FlowField.
+    Occupancy occupancy;                 // Enemies and powerups per cell.
+    int lastPowerupId;                   // Index of the powerup taken on the last tick, or -1.
+    Rng rng;                             // Random source for level generation.
+    ParallelEnemyUpdater *enemyUpdater;  // Optional multi-threaded update (not owned).
+    FrameMetrics *metrics;               // Optional per-phase timing (not owned).
 
     Game();
 };
 
+// Player actions understood by the simulation.
+enum class Action {
+    None,
+    Up,
+    Down,
+    Left,
+    Right
+};
+
+// Outcome flags returned by stepGame(); several can be set in one tick.
+enum StepOutcome {
+    STEP_IGNORED = 0,       // No action, nothing changed.
+    STEP_MOVED   = 1 << 0,  // The player moved.
+    STEP_POWERUP = 1 << 1,  // A powerup was collected.
+    STEP_CAUGHT  = 1 << 2,  // An enemy caught the player (game over).
+    STEP_EXIT    = 1 << 3   // The player is standing on the exit.
+};
+
+class Renderer;
+class LevelPack;
+
+// Screen rows used around the maze: title banner, statistics, controls and
+// a message line.
+const int SCREEN_CHROME_ROWS = 6;
+
+// Settings for an interactive session.
+struct SessionOptions {
+    PursuitMode pursuit;     // Enemy chase strategy.
+    unsigned int seed;       // Seed for level generation.
+    std::string recordPath;  // Replay file to record into, or empty.
+    int rows, cols;          // Maze size for every level.
+    int tickRate;            // Real-time ticks per second; 0 plays turn by turn.
+    int frameRate;           // Most frames drawn per second in real-time play.
+    const LevelPack *pack;   // Levels to play in order instead of generated ones (not owned).
+    int packStart;           // Index of the first pack level to play.
+
+    SessionOptions();
+};
+
+// How closely a real-time session kept to its tick schedule.
+struct LoopTiming {
+    long long ticks;         // Ticks simulated.
+    long long lateTicks;     // Ticks that started more than half a tick late.
+    long long droppedTicks;  // Ticks skipped after falling too far behind.
+    double totalLagMs;       // Sum of start delays over all ticks.
+    double maxLagMs;         // Largest start delay.
+
+    LoopTiming();
+    void record(double lagMs, double tickMs);
+    double meanLagMs() const { return ticks ? totalLagMs / ticks : 0.0; }
+};
+
 // Function prototypes for game functionality.
 void saveGame(const Game &game, const std::string &filename);
 bool loadGame(Game &game, const std::string &filename);
 Position calculateEnemyMove(const Position &enemyPos, const Position &playerPos,
-                              const std::vector<std::vector<char>> &grid);
+                              const Grid &grid);
+void rebuildOccupancy(Game &game);
+void prepareTickScratch(Game &game);
+void moveEnemies(Game &game);
 void carveGuaranteedPath(Game &game);
-void initLevel(Game &game, int level);
+void generateLevel(Game &game, int level, int rows = DEFAULT_ROWS, int cols = DEFAULT_COLS);
+void initLevel(Game &game, int level, int rows = DEFAULT_ROWS, int cols = DEFAULT_COLS);
 void printGrid(const Game &game);
+int collectPowerupAt(Game &game, const Position &pos);
 bool checkAndCollectPowerup(Game &game, const Position &pos);
-void runGame();
+Action actionFromKey(char key);
+int movePlayer(Game &game, Action action);
+int advanceEnemies(Game &game);
+int stepGame(Game &game, Action action);
+void runGame(Renderer &renderer, const SessionOptions &options);
+void runGame(const SessionOptions &options);
 
 #endif  // GAME_H
 
@@ -0,0 +1,113 @@
+#include "Grid.h"
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+char tileToChar(Tile tile) {
+    switch (tile) {
+    case Tile::WallHash: return '#';
+    case Tile::WallAt:   return '@';
+    case Tile::Exit:     return 'E';
+    default:             return ' ';
+    }
+}
+
+Tile charToTile(char c) {
+    switch (c) {
+    case '#': return Tile::WallHash;
+    case '@': return Tile::WallAt;
+    case 'E': return Tile::Exit;
+    default:  return Tile::Floor;
+    }
+}
+
+Grid::Grid() : rows_(0), cols_(0), cells_(std::make_shared<Cells>()) {
+    cells_->blocked.assign(GRID_PADDING, 0);
+    attach();
+}
+
+Grid::Grid(int rows, int cols, Tile fill) : rows_(0), cols_(0), tiles_(nullptr), blocked_(nullptr) {
+    assign(rows, cols, fill);
+}
+
+Grid::Grid(Grid &&other) noexcept
+    : rows_(other.rows_), cols_(other.cols_), cells_(std::move(other.cells_)),
+      tiles_(other.tiles_), blocked_(other.blocked_) {
+    other.release();
+}
+
+Grid &Grid::operator=(Grid &&other) noexcept {
+    if (this != &other) {
+        rows_ = other.rows_;
+        cols_ = other.cols_;
+        cells_ = std::move(other.cells_);
+        tiles_ = other.tiles_;
+        blocked_ = other.blocked_;
+        other.release();
+    }
+    return *this;
+}
+
+void Grid::release() {
+    rows_ = 0;
+    cols_ = 0;
+    tiles_ = nullptr;
+    blocked_ = nullptr;
+}
+
+void Grid::attach() {
+    tiles_ = cells_->tiles.data();
+    blocked_ = cells_->blocked.data();
+}
+
+void Grid::detach() {
+    cells_ = std::make_shared<Cells>(*cells_);
+    attach();
+}
+
+Grid::Cells &Grid::replaceCells() {
+    if (!cells_ || cells_.use_count() > 1)
+        cells_ = std::make_shared<Cells>();
+    return *cells_;
+}
+
+void Grid::assign(int rows, int cols, Tile fill) {
+    rows_ = rows;
+    cols_ = cols;
+    Cells &cells = replaceCells();
+    std::size_t n = static_cast<std::size_t>(rows) * cols;
+    cells.tiles.assign(n, fill);
+    cells.blocked.assign(n + GRID_PADDING, 0);
+    std::fill(cells.blocked.begin(), cells.blocked.begin() + n, tileBlocks(fill) ? 1 : 0);
+    attach();
+}
+
+void Grid::load(int rows, int cols, const unsigned char *tiles) {
+    rows_ = rows;
+    cols_ = cols;
+    Cells &cells = replaceCells();
+    std::size_t n = static_cast<std::size_t>(rows) * cols;
+    cells.tiles.resize(n);
+    cells.blocked.assign(n + GRID_PADDING, 0);
+    std::memcpy(cells.tiles.data(), tiles, n);
+    for (std::size_t i = 0; i < n; i++)
+        cells.blocked[i] = tileBlocks(cells.tiles[i]) ? 1 : 0;
+    attach();
+}
+
+// Clamp a window of the given size around center to [0, extent).
+static int windowStart(int center, int size, int extent) {
+    int start = center - size / 2;
+    if (start > extent - size)
+        start = extent - size;
+    return start < 0 ? 0 : start;
+}
+
+Viewport viewportAround(const Grid &grid, const Position &center, int maxRows, int maxCols) {
+    Viewport view;
+    view.rows = std::min(grid.rows(), std::max(maxRows, 1));
+    view.cols = std::min(grid.cols(), std::max(maxCols, 1));
+    view.top = windowStart(center.x, view.rows, grid.rows());
+    view.left = windowStart(center.y, view.cols, grid.cols());
+    return view;
+}
@@ -0,0 +1,143 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <memory>
+#include <vector>
+#include "Entity.h"
+
+// Default maze dimensions: 20x20.
+const int DEFAULT_ROWS = 20;
+const int DEFAULT_COLS = 20;
+
+// Limits on the number of rows or columns of a maze. The level layouts
+// need at least MIN_MAP_DIM cells per side.
+const int MIN_MAP_DIM = 8;
+const int MAX_MAP_DIM = 4096;
+
+// Zero bytes kept after the last blocked flag (see Grid::blockedData).
+const int GRID_PADDING = 3;
+
+// Kinds of tile a maze cell can hold.
+enum class Tile : unsigned char {
+    Floor,     // ' '
+    WallHash,  // '#'
+    WallAt,    // '@'
+    Exit       // 'E'
+};
+
+// Character used for a tile in saves and on screen.
+char tileToChar(Tile tile);
+
+// Tile for a saved character; anything unknown becomes floor.
+Tile charToTile(char c);
+
+// Whether a tile kind stops movement (both wall types do).
+inline bool tileBlocks(Tile tile) {
+    return tile == Tile::WallHash || tile == Tile::WallAt;
+}
+
+// The maze grid: a single row-major buffer of tiles plus a parallel
+// "blocked" byte per cell, so a movement check is one indexed load.
+//
+// The buffers are shared copy-on-write: copying a Grid only bumps a
+// reference count, and the first change to a shared grid gives it its own
+// buffers. A maze does not change during a level, so game snapshots and
+// forked states all share one copy of it.
+class Grid {
+public:
+    Grid();
+    Grid(int rows, int cols, Tile fill = Tile::Floor);
+
+    // Copies share the buffers. A moved-from grid is left empty, with no
+    // views into the buffers it handed over.
+    Grid(const Grid &other) = default;
+    Grid &operator=(const Grid &other) = default;
+    Grid(Grid &&other) noexcept;
+    Grid &operator=(Grid &&other) noexcept;
+
+    // Resize to rows x cols and fill every cell with the given tile.
+    void assign(int rows, int cols, Tile fill = Tile::Floor);
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int size() const { return rows_ * cols_; }
+
+    // Replace the contents with rows x cols tiles copied from a packed
+    // row-major buffer (one byte per tile).
+    void load(int rows, int cols, const unsigned char *tiles);
+
+    // Packed row-major tile bytes, rows() * cols() long.
+    const unsigned char *data() const {
+        return reinterpret_cast<const unsigned char *>(tiles_);
+    }
+
+    // Row-major index of (x, y); x is the row and y the column.
+    int index(int x, int y) const { return x * cols_ + y; }
+
+    Tile at(int x, int y) const { return tiles_[index(x, y)]; }
+    Tile at(const Position &pos) const { return at(pos.x, pos.y); }
+    bool isBlocked(int x, int y) const { return blocked_[index(x, y)] != 0; }
+
+    // Row-major blocked bytes (1 = wall). The buffer carries GRID_PADDING
+    // zero bytes past the last cell so vector gathers may read 4 bytes at
+    // any cell index.
+    const unsigned char *blockedData() const { return blocked_; }
+
+    void set(int x, int y, Tile tile) {
+        if (cells_.use_count() > 1)
+            detach();
+        int i = index(x, y);
+        tiles_[i] = tile;
+        blocked_[i] = tileBlocks(tile) ? 1 : 0;
+    }
+
+    // Inline so the movement check makes no call; as unsigned, negative
+    // coordinates compare above any bound.
+    bool inBounds(const Position &pos) const {
+        return static_cast<unsigned>(pos.x) < static_cast<unsigned>(rows_) &&
+               static_cast<unsigned>(pos.y) < static_cast<unsigned>(cols_);
+    }
+
+    // Whether both grids use the same buffers (one is an unchanged copy of
+    // the other).
+    bool sharesCellsWith(const Grid &other) const { return cells_ == other.cells_; }
+
+private:
+    struct Cells {
+        std::vector<Tile> tiles;
+        std::vector<unsigned char> blocked;
+    };
+
+    // Give this grid its own copy of the buffers.
+    void detach();
+    // Buffers to overwrite completely: reused if not shared, else fresh.
+    Cells &replaceCells();
+    // Point tiles_ and blocked_ at the current buffers.
+    void attach();
+    // Forget the buffers after they were moved to another grid.
+    void release();
+
+    int rows_;
+    int cols_;
+    std::shared_ptr<Cells> cells_;
+    // Raw views of cells_, so reads cost one load as with plain vectors.
+    Tile *tiles_;
+    unsigned char *blocked_;
+};
+
+// Rectangle of the grid shown on screen.
+struct Viewport {
+    int top, left;    // First visible row and column.
+    int rows, cols;   // Visible size.
+};
+
+// Largest viewport of at most maxRows x maxCols that keeps center in the
+// middle where possible and never runs past the grid's edges.
+Viewport viewportAround(const Grid &grid, const Position &center, int maxRows, int maxCols);
+
+// Check if a move is valid (i.e. inside the maze and not into a wall).
+inline bool isValidMove(const Position &pos, const Grid &grid) {
+    return grid.inBounds(pos) && !grid.isBlocked(pos.x, pos.y);
+}
+
+#endif  // GRID_H
@@ -0,0 +1,177 @@
+#include "Input.h"
+
+#ifdef _WIN32
+    #include <conio.h>
+    #include <windows.h>
+#else
+    #include <csignal>
+    #include <poll.h>
+    #include <termios.h>
+    #include <unistd.h>
+#endif
+
+static TerminalSession *activeSession = nullptr;
+
+#ifndef _WIN32
+
+static struct termios savedMode;
+static volatile sig_atomic_t rawApplied = 0;
+static bool haveSavedMode = false;
+
+static void applyRaw() {
+    struct termios raw = savedMode;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(0, TCSANOW, &raw) == 0)
+        rawApplied = 1;
+}
+
+// Async-signal-safe: tcsetattr is on the POSIX list.
+static void restoreMode() {
+    if (rawApplied) {
+        tcsetattr(0, TCSANOW, &savedMode);
+        rawApplied = 0;
+    }
+}
+
+static void onFatalSignal(int sig) {
+    restoreMode();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void onSuspend(int) {
+    restoreMode();
+    signal(SIGTSTP, SIG_DFL);
+    raise(SIGTSTP);
+}
+
+static void onContinue(int) {
+    if (haveSavedMode && activeSession)
+        applyRaw();
+    signal(SIGTSTP, onSuspend);
+}
+
+static const int FATAL_SIGNALS[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+
+TerminalSession::TerminalSession() {
+    activeSession = this;
+    inputQueue().clear();
+    haveSavedMode = tcgetattr(0, &savedMode) == 0;
+    if (!haveSavedMode)
+        return;  // Not a terminal (e.g. piped input); nothing to restore.
+    for (int sig : FATAL_SIGNALS)
+        signal(sig, onFatalSignal);
+    signal(SIGTSTP, onSuspend);
+    signal(SIGCONT, onContinue);
+    applyRaw();
+}
+
+TerminalSession::~TerminalSession() {
+    restoreMode();
+    if (haveSavedMode) {
+        for (int sig : FATAL_SIGNALS)
+            signal(sig, SIG_DFL);
+        signal(SIGTSTP, SIG_DFL);
+        signal(SIGCONT, SIG_DFL);
+    }
+    haveSavedMode = false;
+    activeSession = nullptr;
+}
+
+bool TerminalSession::isRaw() const {
+    return rawApplied != 0;
+}
+
+void TerminalSession::suspend() {
+    restoreMode();
+}
+
+void TerminalSession::resume() {
+    if (haveSavedMode)
+        applyRaw();
+}
+
+int InputQueue::poll(int timeoutMs) {
+    if (eof_ || count_ == CAPACITY)
+        return 0;
+    struct pollfd pfd;
+    pfd.fd = 0;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (::poll(&pfd, 1, timeoutMs) <= 0)
+        return 0;
+    // Read into the free space of the ring, at most two contiguous pieces.
+    int added = 0;
+    while (count_ < CAPACITY) {
+        std::size_t tail = (head_ + count_) % CAPACITY;
+        std::size_t room = (tail >= head_ ? CAPACITY - tail : head_ - tail);
+        ssize_t n = read(0, buffer_ + tail, room);
+        if (n == 0)
+            eof_ = true;
+        if (n <= 0)
+            break;
+        count_ += static_cast<std::size_t>(n);
+        added += static_cast<int>(n);
+        // Only continue if more is ready right now.
+        pfd.revents = 0;
+        if (static_cast<std::size_t>(n) < room || ::poll(&pfd, 1, 0) <= 0)
+            break;
+    }
+    return added;
+}
+
+#else  // _WIN32
+
+TerminalSession::TerminalSession() {
+    activeSession = this;
+    inputQueue().clear();
+}
+
+TerminalSession::~TerminalSession() {
+    activeSession = nullptr;
+}
+
+// The console delivers keys unbuffered through _getch() already.
+bool TerminalSession::isRaw() const { return true; }
+void TerminalSession::suspend() {}
+void TerminalSession::resume() {}
+
+int InputQueue::poll(int timeoutMs) {
+    DWORD start = GetTickCount();
+    while (!_kbhit()) {
+        if (timeoutMs >= 0 && static_cast<int>(GetTickCount() - start) >= timeoutMs)
+            return 0;
+        Sleep(1);
+    }
+    int added = 0;
+    while (_kbhit() && count_ < CAPACITY) {
+        buffer_[(head_ + count_) % CAPACITY] = static_cast<char>(_getch());
+        count_++;
+        added++;
+    }
+    return added;
+}
+
+#endif
+
+TerminalSession *TerminalSession::current() {
+    return activeSession;
+}
+
+InputQueue::InputQueue() : head_(0), count_(0), eof_(false) {}
+
+char InputQueue::pop() {
+    if (count_ == 0)
+        return 0;
+    char c = buffer_[head_];
+    head_ = (head_ + 1) % CAPACITY;
+    count_--;
+    return c;
+}
+
+InputQueue &inputQueue() {
+    static InputQueue queue;
+    return queue;
+}
@@ -0,0 +1,61 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <cstddef>
+
+// Keeps the terminal in raw mode (no line buffering, no echo) for its
+// whole lifetime instead of switching modes around every keystroke. The
+// original settings come back on destruction and when the process is
+// interrupted, terminated or suspended; raw mode resumes after SIGCONT.
+// While a session exists, getInputChar() reads from inputQueue().
+class TerminalSession {
+public:
+    TerminalSession();
+    ~TerminalSession();
+
+    // Whether stdin is a terminal that was switched to raw mode.
+    bool isRaw() const;
+
+    // Temporarily restore normal line input, e.g. for a typed command.
+    void suspend();
+    void resume();
+
+    static TerminalSession *current();
+
+private:
+    TerminalSession(const TerminalSession &);
+    TerminalSession &operator=(const TerminalSession &);
+};
+
+// Keys read from stdin but not processed yet. poll() drains every pending
+// byte with one read, so a burst of keys costs one wake-up, and nothing
+// typed ahead is lost or echoed.
+class InputQueue {
+public:
+    InputQueue();
+
+    // Wait up to timeoutMs for input (0 = just check, -1 = wait forever),
+    // then move everything available into the queue. Returns the number of
+    // bytes added.
+    int poll(int timeoutMs);
+
+    bool empty() const { return count_ == 0; }
+    std::size_t size() const { return count_; }
+    char pop();
+    void clear() { head_ = count_ = 0; }
+
+    // True once stdin has reached end of file.
+    bool eof() const { return eof_; }
+
+private:
+    static const std::size_t CAPACITY = 4096;
+    char buffer_[CAPACITY];
+    std::size_t head_;
+    std::size_t count_;
+    bool eof_;
+};
+
+// The process-wide queue for stdin.
+InputQueue &inputQueue();
+
+#endif  // INPUT_H
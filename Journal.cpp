@@ -0,0 +1,262 @@
+#include "Journal.h"
+#include "Game.h"
+#include "SaveBinary.h"
+#include "MappedFile.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+
+// File layouts (native byte order, as SaveBinary.h):
+//   <path>.snap  "RWMJ", uint32 generation, binary save image (SaveBinary.h)
+//   <path>.log   "RWML", uint32 generation, then records:
+//                  varint payload length, payload, uint16 low half of CRC-32
+//   payload      uint8 flags (bit 0 game over, bit 1 enemies stepped)
+//                uint8 player step code, uint8 moveCounter,
+//                varint collected count, varint powerup ids,
+//                if enemies stepped: 4 bits per enemy step code
+// A step code packs dx, dy in {-1, 0, 1} as (dx + 1) * 3 + (dy + 1).
+static const char SNAP_MAGIC[4] = {'R', 'W', 'M', 'J'};
+static const char LOG_MAGIC[4] = {'R', 'W', 'M', 'L'};
+static const unsigned char FLAG_GAME_OVER = 1;
+static const unsigned char FLAG_ENEMIES = 2;
+
+static void putVarint(std::vector<unsigned char> &out, std::uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<unsigned char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+// Read a varint; returns false if it runs past end.
+static bool getVarint(const unsigned char *&p, const unsigned char *end, std::uint32_t &v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        unsigned char b = *p++;
+        v |= static_cast<std::uint32_t>(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// Step code for a move of at most one cell per axis, or -1.
+static int stepCode(const Position &from, const Position &to) {
+    int dx = to.x - from.x, dy = to.y - from.y;
+    if (dx < -1 || dx > 1 || dy < -1 || dy > 1)
+        return -1;
+    return (dx + 1) * 3 + (dy + 1);
+}
+
+static Position applyStep(const Position &pos, int code) {
+    return Position{pos.x + code / 3 - 1, pos.y + code % 3 - 1};
+}
+
+static std::string snapPath(const std::string &path) { return path + ".snap"; }
+static std::string logPath(const std::string &path) { return path + ".log"; }
+
+Journal::Journal()
+    : compactEvery(256), log_(nullptr), generation_(0), records_(0), lastPlayer_{0, 0} {}
+
+Journal::~Journal() {
+    end(false);
+}
+
+void Journal::remember(const Game &game) {
+    lastPlayer_ = game.player.pos;
+    lastEnemies_.resize(game.enemies.size());
+    for (size_t i = 0; i < game.enemies.size(); i++)
+        lastEnemies_[i] = game.enemies[i];
+}
+
+// Write a new snapshot generation and restart the log against it.
+bool Journal::writeSnapshot(const Game &game) {
+    generation_++;
+    serializeGame(game, scratch_);
+    std::vector<unsigned char> file(8 + scratch_.size());
+    std::memcpy(file.data(), SNAP_MAGIC, 4);
+    std::memcpy(file.data() + 4, &generation_, 4);
+    std::memcpy(file.data() + 8, scratch_.data(), scratch_.size());
+    if (!writeFileAtomic(snapPath(path_), file.data(), file.size()))
+        return false;
+
+    if (log_)
+        std::fclose(log_);
+    log_ = std::fopen(logPath(path_).c_str(), "wb");
+    if (!log_)
+        return false;
+    std::fwrite(LOG_MAGIC, 1, 4, log_);
+    std::fwrite(&generation_, 4, 1, log_);
+    std::fflush(log_);
+    records_ = 0;
+    remember(game);
+    return true;
+}
+
+// Generation stored in a journal file's header, or 0 if it has none.
+static std::uint32_t fileGeneration(const std::string &file, const char magic[4]) {
+    std::FILE *f = std::fopen(file.c_str(), "rb");
+    if (!f)
+        return 0;
+    unsigned char header[8];
+    std::uint32_t generation = 0;
+    if (std::fread(header, 1, 8, f) == 8 && std::memcmp(header, magic, 4) == 0)
+        std::memcpy(&generation, header + 4, 4);
+    std::fclose(f);
+    return generation;
+}
+
+bool Journal::begin(const Game &game, const std::string &path) {
+    end(false);
+    // Generations only ever grow, across begin() calls and sessions, so a
+    // log left by a crash between renaming a snapshot and truncating the
+    // log never matches the newer snapshot.
+    if (path != path_) {
+        path_ = path;
+        generation_ = std::max(fileGeneration(snapPath(path_), SNAP_MAGIC),
+                               fileGeneration(logPath(path_), LOG_MAGIC));
+    }
+    return writeSnapshot(game);
+}
+
+void Journal::record(const Game &game) {
+    if (!log_)
+        return;
+    int playerCode = stepCode(lastPlayer_, game.player.pos);
+    bool representable = playerCode >= 0 && game.enemies.size() == lastEnemies_.size();
+    bool enemiesMoved = false;
+    for (size_t i = 0; representable && i < game.enemies.size(); i++) {
+        int code = stepCode(lastEnemies_[i], game.enemies[i]);
+        representable = code >= 0;
+        enemiesMoved = enemiesMoved || code != 4;
+    }
+    if (!representable || records_ >= compactEvery) {
+        writeSnapshot(game);
+        return;
+    }
+
+    scratch_.clear();
+    scratch_.push_back(static_cast<unsigned char>((game.gameOver ? FLAG_GAME_OVER : 0) |
+                                                  (enemiesMoved ? FLAG_ENEMIES : 0)));
+    scratch_.push_back(static_cast<unsigned char>(playerCode));
+    scratch_.push_back(static_cast<unsigned char>(game.moveCounter));
+    putVarint(scratch_, game.lastPowerupId >= 0 ? 1 : 0);
+    if (game.lastPowerupId >= 0)
+        putVarint(scratch_, static_cast<std::uint32_t>(game.lastPowerupId));
+    if (enemiesMoved) {
+        size_t base = scratch_.size();
+        scratch_.resize(base + (game.enemies.size() + 1) / 2, 0);
+        for (size_t i = 0; i < game.enemies.size(); i++) {
+            int code = stepCode(lastEnemies_[i], game.enemies[i]);
+            scratch_[base + i / 2] |= static_cast<unsigned char>(code << ((i % 2) * 4));
+        }
+    }
+
+    frame_.clear();
+    putVarint(frame_, static_cast<std::uint32_t>(scratch_.size()));
+    frame_.insert(frame_.end(), scratch_.begin(), scratch_.end());
+    std::uint16_t check = static_cast<std::uint16_t>(crc32(scratch_.data(), scratch_.size()));
+    frame_.push_back(static_cast<unsigned char>(check & 0xFF));
+    frame_.push_back(static_cast<unsigned char>(check >> 8));
+    std::fwrite(frame_.data(), 1, frame_.size(), log_);
+    std::fflush(log_);
+    records_++;
+    remember(game);
+}
+
+void Journal::end(bool discard) {
+    if (log_) {
+        std::fclose(log_);
+        log_ = nullptr;
+    }
+    if (discard && !path_.empty()) {
+        std::remove(snapPath(path_).c_str());
+        std::remove(logPath(path_).c_str());
+    }
+}
+
+bool journalExists(const std::string &path) {
+    std::FILE *f = std::fopen(snapPath(path).c_str(), "rb");
+    if (!f)
+        return false;
+    std::fclose(f);
+    return true;
+}
+
+// Apply one record payload to the game; returns false if it is malformed.
+static bool applyRecord(Game &game, const unsigned char *p, const unsigned char *end) {
+    if (end - p < 3)
+        return false;
+    unsigned char flags = *p++;
+    int playerCode = *p++;
+    int moveCounter = *p++;
+    if (playerCode > 8)
+        return false;
+    Position player = applyStep(game.player.pos, playerCode);
+    if (!game.grid.inBounds(player))
+        return false;
+
+    std::uint32_t collected;
+    if (!getVarint(p, end, collected))
+        return false;
+    if (playerCode != 4)
+        game.totalMoves++;
+    game.player.pos = player;
+    for (std::uint32_t i = 0; i < collected; i++) {
+        std::uint32_t id;
+        if (!getVarint(p, end, id) || static_cast<int>(id) != game.occupancy.powerupAt(player))
+            return false;
+        collectPowerupAt(game, player);
+        game.score += 10;
+    }
+
+    if (flags & FLAG_ENEMIES) {
+        if (static_cast<size_t>(end - p) < (game.enemies.size() + 1) / 2)
+            return false;
+        for (size_t i = 0; i < game.enemies.size(); i++) {
+            int code = (p[i / 2] >> ((i % 2) * 4)) & 0x0F;
+            Position next = applyStep(game.enemies[i], code);
+            if (code > 8 || !game.grid.inBounds(next))
+                return false;
+            game.occupancy.moveEnemy(game.enemies[i], next);
+            game.enemies.set(i, next);
+        }
+    }
+    game.moveCounter = moveCounter;
+    game.gameOver = (flags & FLAG_GAME_OVER) != 0;
+    return true;
+}
+
+bool recoverJournal(Game &game, const std::string &path) {
+    MappedFile snap;
+    if (!snap.open(snapPath(path)) || snap.size() < 8 ||
+        std::memcmp(snap.data(), SNAP_MAGIC, 4) != 0)
+        return false;
+    std::uint32_t generation;
+    std::memcpy(&generation, snap.data() + 4, 4);
+    Game recovered;
+    if (!deserializeGame(recovered, snap.data() + 8, snap.size() - 8))
+        return false;
+
+    MappedFile log;
+    std::uint32_t logGeneration = 0;
+    if (log.open(logPath(path)) && log.size() >= 8 &&
+        std::memcmp(log.data(), LOG_MAGIC, 4) == 0)
+        std::memcpy(&logGeneration, log.data() + 4, 4);
+    if (logGeneration == generation) {
+        const unsigned char *p = log.data() + 8;
+        const unsigned char *end = log.data() + log.size();
+        while (p < end) {
+            std::uint32_t length;
+            if (!getVarint(p, end, length) || static_cast<std::uint32_t>(end - p) < length + 2)
+                break;  // Torn final record.
+            std::uint16_t check = static_cast<std::uint16_t>(p[length] | (p[length + 1] << 8));
+            if (check != static_cast<std::uint16_t>(crc32(p, length)) ||
+                !applyRecord(recovered, p, p + length))
+                break;
+            p += length + 2;
+        }
+    }
+    game = recovered;
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Entity.h"
+
+struct Game;
+
+// Crash-safe autosave. begin() writes a full snapshot to <path>.snap; each
+// record() then appends a few bytes to <path>.log describing what changed
+// on that tick (player step, enemy steps, collected powerup ids). Every
+// compactEvery records the snapshot is rewritten and the log restarted.
+//
+// Snapshot and log both carry a generation number, so a crash in the middle
+// of compaction never replays an old log onto a newer snapshot.
+class Journal {
+public:
+    Journal();
+    ~Journal();
+
+    // Start journaling to the given base path with a fresh snapshot.
+    bool begin(const Game &game, const std::string &path);
+
+    // Append a record for the tick that just ran. Falls back to a new
+    // snapshot if the change cannot be expressed as single steps.
+    void record(const Game &game);
+
+    // Stop journaling; with discard the autosave files are removed.
+    void end(bool discard);
+
+    bool isActive() const { return log_ != nullptr; }
+
+    int compactEvery;  // Records between snapshots (default 256).
+
+private:
+    bool writeSnapshot(const Game &game);
+    void remember(const Game &game);
+
+    std::string path_;
+    std::FILE *log_;
+    std::uint32_t generation_;
+    int records_;
+    Position lastPlayer_;
+    std::vector<Position> lastEnemies_;
+    std::vector<unsigned char> scratch_;  // Reused record payload.
+    std::vector<unsigned char> frame_;    // Reused framed record.
+};
+
+// Whether an autosave exists at the given base path.
+bool journalExists(const std::string &path);
+
+// Restore the snapshot at <path>.snap and replay <path>.log onto it. A torn
+// final record (from a crash mid-write) is ignored.
+bool recoverJournal(Game &game, const std::string &path);
+
+#endif  // JOURNAL_H
@@ -0,0 +1,198 @@
+#include "LevelAnalysis.h"
+#include <algorithm>
+#include <cstring>
+
+LevelAnalysis::LevelAnalysis() : pathLength(-1), safetyMargin(NO_THREAT), reachablePowerups(0) {}
+
+AnalysisLimits::AnalysisLimits() : minSafetyMargin(-NO_THREAT), maxDetour(-1) {}
+
+bool passesAnalysis(const LevelAnalysis &analysis, const AnalysisLimits &limits) {
+    if (analysis.pathLength < 0 || analysis.safetyMargin < limits.minSafetyMargin)
+        return false;
+    if (limits.maxDetour >= 0) {
+        for (int detour : analysis.detours) {
+            if (detour > limits.maxDetour)
+                return false;
+        }
+    }
+    return true;
+}
+
+// FNV-1a over the maze and every entity position.
+static std::uint64_t fingerprint(const Game &game) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h](std::uint64_t v) {
+        h ^= v;
+        h *= 0x100000001b3ULL;
+    };
+    mix(static_cast<std::uint64_t>(game.grid.rows()) << 32 | static_cast<std::uint32_t>(game.grid.cols()));
+    const unsigned char *tiles = game.grid.data();
+    for (int i = 0; i < game.grid.size(); i++)
+        mix(tiles[i]);
+    auto mixPos = [&mix](const Position &p) {
+        mix(static_cast<std::uint64_t>(static_cast<std::uint32_t>(p.x)) << 32 | static_cast<std::uint32_t>(p.y));
+    };
+    mixPos(game.player.pos);
+    mixPos(game.exitPos);
+    mix(game.enemies.size());
+    for (std::size_t i = 0; i < game.enemies.size(); i++)
+        mixPos(game.enemies[i]);
+    mix(game.powerups.size());
+    for (const Position &p : game.powerups)
+        mixPos(p);
+    return h;
+}
+
+LevelAnalyzer::LevelAnalyzer(std::size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1), hits_(0) {}
+
+static bool samePosition(const Position &a, const Position &b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+bool LevelAnalyzer::matches(const Entry &entry, const Game &game) {
+    const Grid &grid = game.grid;
+    if (entry.grid.rows() != grid.rows() || entry.grid.cols() != grid.cols() ||
+        !samePosition(entry.player, game.player.pos) || !samePosition(entry.exitPos, game.exitPos) ||
+        entry.enemies.size() != game.enemies.size() || entry.powerups.size() != game.powerups.size())
+        return false;
+    for (std::size_t i = 0; i < game.enemies.size(); i++) {
+        if (!samePosition(entry.enemies[i], game.enemies[i]))
+            return false;
+    }
+    for (std::size_t i = 0; i < game.powerups.size(); i++) {
+        if (!samePosition(entry.powerups[i], game.powerups[i]))
+            return false;
+    }
+    return entry.grid.sharesCellsWith(grid) ||
+           std::memcmp(entry.grid.data(), grid.data(), static_cast<std::size_t>(grid.size())) == 0;
+}
+
+const LevelAnalysis &LevelAnalyzer::analyze(const Game &game) {
+    std::uint64_t key = fingerprint(game);
+    auto found = cache_.find(key);
+    if (found != cache_.end() && matches(found->second, game)) {
+        hits_++;
+        return found->second.analysis;
+    }
+    if (found == cache_.end()) {
+        if (cache_.size() >= capacity_) {
+            cache_.erase(order_.front());
+            order_.pop_front();
+        }
+        order_.push_back(key);
+    }
+    // A new level, or one whose fingerprint collides with a cached level:
+    // either way the entry now describes this one.
+    Entry &entry = cache_[key];
+    entry.grid = game.grid;
+    entry.player = game.player.pos;
+    entry.exitPos = game.exitPos;
+    entry.enemies = game.enemies;
+    entry.powerups = game.powerups;
+    compute(game, entry.analysis);
+    return entry.analysis;
+}
+
+// Breadth-first fill from every cell already at distance 0 in dist (the
+// rest must be -1). Leaves the cells in visiting order at the front of
+// queue_ and returns how many were reached.
+int LevelAnalyzer::bfs(const Grid &grid, std::vector<int> &dist) {
+    int rows = grid.rows();
+    int cols = grid.cols();
+    queue_.resize(grid.size());
+    int head = 0, tail = 0;
+    for (int i = 0; i < grid.size(); i++) {
+        if (dist[i] == 0)
+            queue_[tail++] = i;
+    }
+    while (head < tail) {
+        int cell = queue_[head++];
+        int x = cell / cols;
+        int y = cell % cols;
+        int next = dist[cell] + 1;
+        if (x > 0 && dist[cell - cols] < 0 && !grid.isBlocked(x - 1, y)) {
+            dist[cell - cols] = next;
+            queue_[tail++] = cell - cols;
+        }
+        if (x < rows - 1 && dist[cell + cols] < 0 && !grid.isBlocked(x + 1, y)) {
+            dist[cell + cols] = next;
+            queue_[tail++] = cell + cols;
+        }
+        if (y > 0 && dist[cell - 1] < 0 && !grid.isBlocked(x, y - 1)) {
+            dist[cell - 1] = next;
+            queue_[tail++] = cell - 1;
+        }
+        if (y < cols - 1 && dist[cell + 1] < 0 && !grid.isBlocked(x, y + 1)) {
+            dist[cell + 1] = next;
+            queue_[tail++] = cell + 1;
+        }
+    }
+    return tail;
+}
+
+void LevelAnalyzer::compute(const Game &game, LevelAnalysis &out) {
+    const Grid &grid = game.grid;
+    int cols = grid.cols();
+    int n = grid.size();
+
+    // All enemy spawns seed one fill.
+    out.enemyDistance.assign(n, -1);
+    for (std::size_t i = 0; i < game.enemies.size(); i++) {
+        Position e = game.enemies[i];
+        if (isValidMove(e, grid))
+            out.enemyDistance[grid.index(e.x, e.y)] = 0;
+    }
+    bfs(grid, out.enemyDistance);
+
+    fromStart_.assign(n, -1);
+    fromExit_.assign(n, -1);
+    int start = grid.index(game.player.pos.x, game.player.pos.y);
+    int exit = grid.index(game.exitPos.x, game.exitPos.y);
+    if (isValidMove(game.player.pos, grid))
+        fromStart_[start] = 0;
+    if (isValidMove(game.exitPos, grid))
+        fromExit_[exit] = 0;
+    bfs(grid, fromExit_);
+    int reached = bfs(grid, fromStart_);
+
+    out.pathLength = fromStart_[exit];
+    out.reachablePowerups = 0;
+    out.detours.assign(game.powerups.size(), -1);
+    for (std::size_t i = 0; i < game.powerups.size(); i++) {
+        int cell = grid.index(game.powerups[i].x, game.powerups[i].y);
+        if (out.pathLength >= 0 && fromStart_[cell] >= 0) {
+            out.reachablePowerups++;
+            out.detours[i] = fromStart_[cell] + fromExit_[cell] - out.pathLength;
+        }
+    }
+    if (out.pathLength < 0) {
+        out.safetyMargin = -NO_THREAT;
+        return;
+    }
+
+    // Walk the cells on shortest paths in the start fill's order; best_[c]
+    // is the largest smallest-margin of any shortest path to c.
+    best_.assign(n, -NO_THREAT);
+    for (int k = 0; k < reached; k++) {
+        int cell = queue_[k];
+        int t = fromStart_[cell];
+        if (fromExit_[cell] < 0 || t + fromExit_[cell] != out.pathLength)
+            continue;
+        int margin = out.enemyDistance[cell] < 0 ? NO_THREAT : out.enemyDistance[cell] - t;
+        int incoming = NO_THREAT;
+        if (t > 0) {
+            incoming = -NO_THREAT;
+            int x = cell / cols;
+            int y = cell % cols;
+            const int neighbours[4] = {x > 0 ? cell - cols : -1, x < grid.rows() - 1 ? cell + cols : -1,
+                                       y > 0 ? cell - 1 : -1, y < cols - 1 ? cell + 1 : -1};
+            for (int prev : neighbours) {
+                if (prev >= 0 && fromStart_[prev] == t - 1 && best_[prev] > incoming)
+                    incoming = best_[prev];
+            }
+        }
+        best_[cell] = std::min(margin, incoming);
+    }
+    out.safetyMargin = best_[exit];
+}
@@ -0,0 +1,86 @@
+#ifndef LEVELANALYSIS_H
+#define LEVELANALYSIS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "Game.h"
+
+// Safety margin of a cell no enemy can reach.
+const int NO_THREAT = 1 << 30;
+
+// Static properties of a level, computed from maze distances alone.
+struct LevelAnalysis {
+    int pathLength;               // Shortest start-to-exit moves; -1 if unreachable.
+    int safetyMargin;             // Best over shortest paths of the smallest
+                                  // (enemy distance - steps taken) on the path.
+    int reachablePowerups;
+    std::vector<int> detours;     // Per powerup: extra moves to collect it on
+                                  // the way to the exit, or -1 if unreachable.
+    std::vector<int> enemyDistance;  // Per cell: moves from the nearest enemy
+                                     // spawn, -1 for walls and sealed cells.
+
+    LevelAnalysis();
+};
+
+// Filter thresholds for passesAnalysis().
+struct AnalysisLimits {
+    int minSafetyMargin;  // Reject maps an enemy can cut off closer than this
+                          // (default: only the exit must be reachable).
+    int maxDetour;        // Reject maps with a powerup detour above this (-1 = any).
+
+    AnalysisLimits();
+};
+
+// Whether a map is worth the slower simulation-based checks.
+bool passesAnalysis(const LevelAnalysis &analysis, const AnalysisLimits &limits);
+
+// Computes LevelAnalysis with three multi-source BFS passes (from the enemy
+// spawns, the start and the exit) over reused buffers, and caches results
+// for the last capacity levels analyzed, so repeated queries for the same
+// level skip the passes. Entries are found by a fingerprint of the maze and
+// entity positions and then compared in full, so a fingerprint collision
+// is a miss rather than another level's result.
+class LevelAnalyzer {
+public:
+    explicit LevelAnalyzer(std::size_t capacity = 256);
+
+    // The returned analysis stays valid until the next call.
+    const LevelAnalysis &analyze(const Game &game);
+
+    std::size_t cacheSize() const { return cache_.size(); }
+    long long cacheHits() const { return hits_; }
+    void clearCache() {
+        cache_.clear();
+        order_.clear();
+    }
+
+private:
+    // A cached level: its state, shared with the game where possible (the
+    // maze is copy-on-write), and its analysis.
+    struct Entry {
+        Grid grid;
+        Position player;
+        Position exitPos;
+        EnemyList enemies;
+        std::vector<Position> powerups;
+        LevelAnalysis analysis;
+    };
+
+    static bool matches(const Entry &entry, const Game &game);
+    void compute(const Game &game, LevelAnalysis &out);
+    int bfs(const Grid &grid, std::vector<int> &dist);
+
+    std::size_t capacity_;
+    std::unordered_map<std::uint64_t, Entry> cache_;
+    std::deque<std::uint64_t> order_;  // Cached fingerprints, oldest first.
+    long long hits_;
+    std::vector<int> fromStart_;
+    std::vector<int> fromExit_;
+    std::vector<int> best_;
+    std::vector<int> queue_;
+};
+
+#endif  // LEVELANALYSIS_H
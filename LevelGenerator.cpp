@@ -0,0 +1,85 @@
+#include "LevelGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+bool isLevelReachable(const Game &game, FlowField &scratch) {
+    // Distances are symmetric, so one fill from the start answers every query.
+    scratch.build(game.grid, game.player.pos);
+    if (scratch.distance(game.player.pos) < 0 || scratch.distance(game.exitPos) < 0)
+        return false;
+    for (const auto &p : game.powerups) {
+        if (scratch.distance(p) < 0)
+            return false;
+    }
+    return true;
+}
+
+void spawnEnemies(Game &game, int count) {
+    int rows = game.grid.rows();
+    int cols = game.grid.cols();
+    game.enemies.reserve(game.enemies.size() + count);
+    // Give up after a bounded number of draws on mazes with little floor.
+    const long long maxTries = 64LL * count + 1024;
+    for (long long tries = 0; count > 0 && tries < maxTries; tries++) {
+        Position pos = {static_cast<int>(game.rng.below(rows)), static_cast<int>(game.rng.below(cols))};
+        if (!isValidMove(pos, game.grid) || game.grid.at(pos) == Tile::Exit ||
+            (pos.x == game.player.pos.x && pos.y == game.player.pos.y))
+            continue;
+        game.enemies.push_back(pos);
+        game.occupancy.addEnemy(pos);
+        count--;
+    }
+}
+
+BatchStats generateLevels(std::vector<Game> &out, int count, int level,
+                          std::uint64_t baseSeed, int threads, int maxAttempts,
+                          int rows, int cols) {
+    if (threads <= 0)
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0)
+        threads = 1;
+    if (threads > count)
+        threads = count > 0 ? count : 1;
+
+    out.assign(count, Game());
+    std::atomic<int> next(0);
+    std::atomic<long long> attempts(0);
+    std::atomic<int> fallbacks(0);
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        FlowField scratch;
+        long long localAttempts = 0;
+        for (int i = next++; i < count; i = next++) {
+            Game &game = out[i];
+            game.rng.seed(baseSeed + static_cast<std::uint64_t>(i));
+            bool accepted = false;
+            for (int attempt = 0; attempt < maxAttempts && !accepted; attempt++) {
+                generateLevel(game, level, rows, cols);
+                localAttempts++;
+                accepted = isLevelReachable(game, scratch);
+            }
+            if (!accepted) {
+                carveGuaranteedPath(game);
+                fallbacks++;
+            }
+        }
+        attempts += localAttempts;
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &thread : pool)
+        thread.join();
+
+    BatchStats stats;
+    stats.maps = count;
+    stats.attempts = attempts;
+    stats.fallbacks = fallbacks;
+    stats.threads = threads;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
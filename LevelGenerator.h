@@ -0,0 +1,40 @@
+#ifndef LEVELGENERATOR_H
+#define LEVELGENERATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "Game.h"
+
+// Whether the exit and every powerup can be reached from the player's
+// start. Uses the given field as flood-fill scratch space.
+bool isLevelReachable(const Game &game, FlowField &scratch);
+
+// Add count enemies on random open floor cells, avoiding the player's
+// start and the exit. Used to build swarm levels.
+void spawnEnemies(Game &game, int count);
+
+// Result of a batch generation run.
+struct BatchStats {
+    int maps;              // Maps produced.
+    long long attempts;    // Mazes generated, including rejected ones.
+    int fallbacks;         // Maps that hit maxAttempts and got the carved corridor.
+    int threads;           // Worker threads used.
+    double seconds;        // Wall-clock time.
+
+    double mapsPerSecond() const { return seconds > 0 ? maps / seconds : 0.0; }
+    double rejectionRate() const {
+        return attempts > 0 ? static_cast<double>(attempts - maps) / attempts : 0.0;
+    }
+};
+
+// Generate count maps of the given level on a pool of worker threads
+// (0 = one per hardware thread). Each map is generated without the forced
+// corridor and regenerated until isLevelReachable() accepts it. Map i is
+// seeded from baseSeed + i, so the output does not depend on the number
+// of threads.
+BatchStats generateLevels(std::vector<Game> &out, int count, int level,
+                          std::uint64_t baseSeed, int threads = 0,
+                          int maxAttempts = 1000, int rows = DEFAULT_ROWS,
+                          int cols = DEFAULT_COLS);
+
+#endif  // LEVELGENERATOR_H
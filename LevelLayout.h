@@ -0,0 +1,161 @@
+#ifndef LEVELLAYOUT_H
+#define LEVELLAYOUT_H
+
+#include <cstring>
+#include "Game.h"
+
+// The parts of a generated level that do not depend on the random seed:
+// border walls, level 2's cross-shaped overlay, and the player, exit,
+// enemy and powerup cells. Everything here is constexpr, so for a fixed
+// map size the whole structure is a table built by the compiler.
+
+const int MAX_SPAWN_ENEMIES = 5;
+const int MAX_SPAWN_POWERUPS = 3;
+
+// Starting enemies and powerups of a level.
+struct SpawnTable {
+    int enemyCount;
+    Position enemies[MAX_SPAWN_ENEMIES];
+    int powerupCount;
+    Position powerups[MAX_SPAWN_POWERUPS];
+};
+
+// Spawn cells for a level on a rows x cols maze (level 1, or anything else
+// for the harder layout).
+constexpr SpawnTable levelSpawns(int level, int rows, int cols) {
+    if (level == 1)
+        return SpawnTable{3,
+                          {{1, cols - 2},          // Top-right.
+                           {rows / 2, 1},          // Middle-left.
+                           {rows / 2, cols - 3}},  // Middle-right.
+                          2,
+                          {{rows / 2, cols / 2}, {3, cols - 4}}};
+    return SpawnTable{5,
+                      {{1, cols - 2},          // Top-right.
+                       {rows - 2, 1},          // Bottom-left.
+                       {rows / 2, cols - 2},   // Middle-right.
+                       {rows - 2, cols / 2},   // Bottom-middle.
+                       {rows / 3, cols / 3}},  // Upper-left-ish.
+                      3,
+                      {{rows / 2, 2}, {rows - 3, cols - 3}, {2, 2}}};
+}
+
+// Percentage of interior cells that start as walls.
+constexpr int levelFillChance(int level) {
+    return level == 1 ? 15 : 25;
+}
+
+// If the level's fixed structure decides cell (i, j), store its tile and
+// return true; return false for cells left to the random fill. Checks run
+// from the last structure generateLevel() places to the first, so the
+// first match is the tile that ends up on the cell.
+constexpr bool fixedTile(int level, int rows, int cols, int i, int j, Tile &tile) {
+    SpawnTable spawns = levelSpawns(level, rows, cols);
+    for (int k = 0; k < spawns.powerupCount; k++) {
+        if (spawns.powerups[k].x == i && spawns.powerups[k].y == j) {
+            tile = Tile::Floor;
+            return true;
+        }
+    }
+    for (int k = 0; k < spawns.enemyCount; k++) {
+        if (spawns.enemies[k].x == i && spawns.enemies[k].y == j) {
+            tile = Tile::Floor;
+            return true;
+        }
+    }
+    if (i == rows - 2 && j == cols - 2) {
+        tile = Tile::Exit;
+        return true;
+    }
+    if (i == 1 && j == 1) {
+        tile = Tile::Floor;
+        return true;
+    }
+    bool interior = i > 0 && i < rows - 1 && j > 0 && j < cols - 1;
+    if (level == 2 && interior) {
+        // Horizontal wall across the middle with a gap, drawn over the
+        // vertical one down the middle with two gaps.
+        if (i == rows / 2 && j != cols / 4) {
+            tile = Tile::WallAt;
+            return true;
+        }
+        if (j == cols / 2 && i != rows / 3 && i != (2 * rows) / 3) {
+            tile = Tile::WallHash;
+            return true;
+        }
+    }
+    if (!interior) {
+        tile = Tile::WallHash;
+        return true;
+    }
+    return false;
+}
+
+// Compile-time image of a level's fixed structure on a Rows x Cols maze:
+// the tile bytes to start from and which cells the random fill must not
+// touch.
+template <int Rows, int Cols, int Level>
+struct LevelLayout {
+    static_assert(Rows >= MIN_MAP_DIM && Cols >= MIN_MAP_DIM, "maze too small");
+    static_assert(Rows <= MAX_MAP_DIM && Cols <= MAX_MAP_DIM, "maze too large");
+
+    unsigned char tiles[Rows * Cols];
+    bool fixed[Rows * Cols];
+
+    constexpr LevelLayout() : tiles(), fixed() {
+        for (int i = 0; i < Rows; i++) {
+            for (int j = 0; j < Cols; j++) {
+                Tile tile = Tile::Floor;
+                fixed[i * Cols + j] = fixedTile(Level, Rows, Cols, i, j, tile);
+                tiles[i * Cols + j] = static_cast<unsigned char>(tile);
+            }
+        }
+    }
+};
+
+template <int Rows, int Cols, int Level>
+struct LevelImage {
+    static constexpr LevelLayout<Rows, Cols, Level> layout{};
+};
+
+// generateLevel() for a maze size known at compile time. The grid starts as
+// a copy of the precomputed image and only the random cells are written,
+// with loop bounds and indices that are constants. The generator is drawn
+// from exactly as in the general version, so a seed gives the same level.
+template <int Rows, int Cols, int Level>
+void generateFixedLevel(Game &game) {
+    const LevelLayout<Rows, Cols, Level> &layout = LevelImage<Rows, Cols, Level>::layout;
+    unsigned char tiles[Rows * Cols];
+    std::memcpy(tiles, layout.tiles, sizeof(tiles));
+
+    // A local copy of the generator: byte stores into tiles could otherwise
+    // alias its state and force a reload on every draw.
+    Rng rng = game.rng;
+    const int fillChance = levelFillChance(Level);
+    for (int i = 1; i < Rows - 1; i++) {
+        for (int j = 1; j < Cols - 1; j++) {
+            // Draw the wall type unconditionally and keep the advanced
+            // state only for a wall, so the 15-25% roll compiles to
+            // selects instead of a branch that mispredicts.
+            bool wall = static_cast<int>(rng.below(100)) < fillChance;
+            Rng peek = rng;
+            Tile wallTile = peek.below(2) == 0 ? Tile::WallHash : Tile::WallAt;
+            Tile tile = wall ? wallTile : Tile::Floor;
+            rng.setState(wall ? peek.state() : rng.state(), rng.increment());
+            if (!layout.fixed[i * Cols + j])
+                tiles[i * Cols + j] = static_cast<unsigned char>(tile);
+        }
+    }
+    game.rng = rng;
+    game.grid.load(Rows, Cols, tiles);
+
+    constexpr SpawnTable spawns = levelSpawns(Level, Rows, Cols);
+    game.player.pos = {1, 1};
+    game.exitPos = {Rows - 2, Cols - 2};
+    game.enemies.clear();
+    for (int k = 0; k < spawns.enemyCount; k++)
+        game.enemies.push_back(spawns.enemies[k]);
+    game.powerups.assign(spawns.powerups, spawns.powerups + spawns.powerupCount);
+}
+
+#endif  // LEVELLAYOUT_H
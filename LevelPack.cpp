@@ -0,0 +1,254 @@
+#include "LevelPack.h"
+#include "Game.h"
+#include "SaveBinary.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+// Bytes used by a record's grid blob, padded so the entity arrays stay
+// aligned.
+static std::size_t paddedGridSize(std::int32_t rows, std::int32_t cols) {
+    std::size_t n = static_cast<std::size_t>(rows) * static_cast<std::size_t>(cols);
+    return (n + 3) & ~static_cast<std::size_t>(3);
+}
+
+static void appendBytes(std::vector<unsigned char> &out, const void *data, std::size_t size) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    out.insert(out.end(), p, p + size);
+}
+
+LevelPack::LevelPack() : index_(nullptr), count_(0) {}
+
+bool LevelPack::open(const std::string &path) {
+    close();
+    if (!file_.open(path))
+        return false;
+    PackHeader header;
+    if (file_.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    std::uint64_t indexBytes = static_cast<std::uint64_t>(header.levelCount) * sizeof(PackIndexEntry);
+    if (std::memcmp(header.magic, "RWMP", 4) != 0 || header.version != PACK_VERSION ||
+        header.levelCount == 0 || header.levelCount > 0x7fffffffu ||
+        header.indexOffset < sizeof(header) || header.indexOffset > file_.size() ||
+        indexBytes > file_.size() - header.indexOffset) {
+        close();
+        return false;
+    }
+    index_ = file_.data() + header.indexOffset;
+    count_ = static_cast<int>(header.levelCount);
+    return true;
+}
+
+void LevelPack::close() {
+    file_.close();
+    index_ = nullptr;
+    count_ = 0;
+}
+
+bool LevelPack::load(int index, Game &game) const {
+    if (index < 0 || index >= count_)
+        return false;
+    PackIndexEntry entry;
+    std::memcpy(&entry, index_ + static_cast<std::size_t>(index) * sizeof(entry), sizeof(entry));
+    if (entry.offset > file_.size() || entry.size > file_.size() - entry.offset ||
+        entry.size < sizeof(LevelRecord))
+        return false;
+    const unsigned char *data = file_.data() + entry.offset;
+    if (crc32(data, entry.size) != entry.crc)
+        return false;
+
+    LevelRecord record;
+    std::memcpy(&record, data, sizeof(record));
+    if (record.rows <= 0 || record.cols <= 0 ||
+        record.rows > MAX_MAP_DIM || record.cols > MAX_MAP_DIM)
+        return false;
+    std::size_t cells = static_cast<std::size_t>(record.rows) * record.cols;
+    if (record.enemyCount > cells || record.powerupCount > cells)
+        return false;
+    std::size_t gridBytes = paddedGridSize(record.rows, record.cols);
+    std::size_t entityCount = record.enemyCount + static_cast<std::size_t>(record.powerupCount);
+    if (entry.size != sizeof(record) + gridBytes + 8 * entityCount)
+        return false;
+
+    const unsigned char *tiles = data + sizeof(record);
+    for (std::size_t i = 0; i < cells; i++) {
+        if (tiles[i] > static_cast<unsigned char>(Tile::Exit))
+            return false;
+    }
+    Position player = {record.playerX, record.playerY};
+    Position exit = {record.exitX, record.exitY};
+    if (!inBounds(player, record.rows, record.cols) || !inBounds(exit, record.rows, record.cols))
+        return false;
+    const unsigned char *entities = tiles + gridBytes;
+    for (std::size_t i = 0; i < entityCount; i++) {
+        std::int32_t xy[2];
+        std::memcpy(xy, entities + 8 * i, sizeof(xy));
+        if (!inBounds(Position{xy[0], xy[1]}, record.rows, record.cols))
+            return false;
+    }
+
+    game.grid.load(record.rows, record.cols, tiles);
+    game.level = index + 1;
+    game.score = 0;
+    game.moveCounter = 0;
+    game.totalMoves = 0;
+    game.enemyDelay = record.enemyDelay > 0 ? record.enemyDelay : 1;
+    game.gameOver = false;
+    game.player.pos = player;
+    game.exitPos = exit;
+    game.enemies.resize(record.enemyCount);
+    for (std::uint32_t i = 0; i < record.enemyCount; i++) {
+        std::int32_t xy[2];
+        std::memcpy(xy, entities + 8 * i, sizeof(xy));
+        game.enemies.set(i, Position{xy[0], xy[1]});
+    }
+    const unsigned char *powerups = entities + 8 * static_cast<std::size_t>(record.enemyCount);
+    game.powerups.resize(record.powerupCount);
+    for (std::uint32_t i = 0; i < record.powerupCount; i++) {
+        std::int32_t xy[2];
+        std::memcpy(xy, powerups + 8 * i, sizeof(xy));
+        game.powerups[i] = {xy[0], xy[1]};
+    }
+    rebuildOccupancy(game);
+    return true;
+}
+
+void appendLevelRecord(const Game &game, std::vector<unsigned char> &out) {
+    LevelRecord record;
+    record.rows = game.grid.rows();
+    record.cols = game.grid.cols();
+    record.playerX = game.player.pos.x;
+    record.playerY = game.player.pos.y;
+    record.exitX = game.exitPos.x;
+    record.exitY = game.exitPos.y;
+    record.enemyDelay = game.enemyDelay;
+    record.enemyCount = static_cast<std::uint32_t>(game.enemies.size());
+    record.powerupCount = static_cast<std::uint32_t>(game.powerups.size());
+    record.reserved = 0;
+
+    std::size_t start = out.size();
+    appendBytes(out, &record, sizeof(record));
+    appendBytes(out, game.grid.data(), static_cast<std::size_t>(game.grid.size()));
+    out.resize(start + sizeof(record) + paddedGridSize(record.rows, record.cols), 0);
+    for (size_t i = 0; i < game.enemies.size(); i++) {
+        std::int32_t xy[2] = {game.enemies.xs()[i], game.enemies.ys()[i]};
+        appendBytes(out, xy, sizeof(xy));
+    }
+    for (const auto &p : game.powerups) {
+        std::int32_t xy[2] = {p.x, p.y};
+        appendBytes(out, xy, sizeof(xy));
+    }
+}
+
+bool writeLevelPack(const std::string &path, const std::vector<Game> &levels) {
+    if (levels.empty())
+        return false;
+    PackHeader header;
+    std::memcpy(header.magic, "RWMP", 4);
+    header.version = PACK_VERSION;
+    header.levelCount = static_cast<std::uint32_t>(levels.size());
+    header.reserved = 0;
+    header.indexOffset = sizeof(header);
+
+    // Records go after the index, which is filled in once their offsets
+    // are known.
+    std::vector<unsigned char> image(sizeof(header) + levels.size() * sizeof(PackIndexEntry), 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    for (std::size_t i = 0; i < levels.size(); i++) {
+        PackIndexEntry entry;
+        entry.offset = image.size();
+        appendLevelRecord(levels[i], image);
+        entry.size = static_cast<std::uint32_t>(image.size() - entry.offset);
+        entry.crc = crc32(image.data() + entry.offset, entry.size);
+        std::memcpy(image.data() + header.indexOffset + i * sizeof(entry), &entry, sizeof(entry));
+    }
+    return writeFileAtomic(path, image.data(), image.size());
+}
+
+bool parseMapText(const std::string &text, Game &game, std::string &error) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        lines.push_back(line);
+    }
+    while (!lines.empty() && lines.back().empty())
+        lines.pop_back();
+    std::size_t cols = 0;
+    for (const std::string &l : lines)
+        cols = std::max(cols, l.size());
+    if (lines.empty() || cols == 0) {
+        error = "the map is empty";
+        return false;
+    }
+    if (lines.size() > static_cast<std::size_t>(MAX_MAP_DIM) ||
+        cols > static_cast<std::size_t>(MAX_MAP_DIM)) {
+        error = "the map is larger than 4096x4096";
+        return false;
+    }
+
+    int rows = static_cast<int>(lines.size());
+    Grid grid(rows, static_cast<int>(cols), Tile::Floor);
+    EnemyList enemies;
+    std::vector<Position> powerups;
+    int players = 0, exits = 0;
+    Position player = {0, 0}, exit = {0, 0};
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < static_cast<int>(lines[i].size()); j++) {
+            char c = lines[i][j];
+            Position pos = {i, j};
+            switch (c) {
+            case '#':
+            case '@':
+                grid.set(i, j, charToTile(c));
+                break;
+            case ' ':
+            case '.':
+                break;
+            case 'P':
+                player = pos;
+                players++;
+                break;
+            case 'E':
+                grid.set(i, j, Tile::Exit);
+                exit = pos;
+                exits++;
+                break;
+            case 'X':
+                enemies.push_back(pos);
+                break;
+            case '*':
+                powerups.push_back(pos);
+                break;
+            default:
+                error = std::string("unknown map character '") + c + "' on line " +
+                        std::to_string(i + 1);
+                return false;
+            }
+        }
+    }
+    if (players != 1 || exits != 1) {
+        error = "the map needs exactly one P and one E";
+        return false;
+    }
+
+    game.grid = grid;
+    game.player.pos = player;
+    game.exitPos = exit;
+    game.enemies = enemies;
+    game.powerups = powerups;
+    game.level = 1;
+    game.score = 0;
+    game.moveCounter = 0;
+    game.totalMoves = 0;
+    game.enemyDelay = 1;
+    game.gameOver = false;
+    rebuildOccupancy(game);
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+struct Game;
+
+// Level pack format (version 1), integers in native byte order (the
+// records are copied as structs, so packs built on one machine load only on
+// machines of the same endianness):
+//   header   PackHeader (magic "RWMP", version, level count, index offset)
+//   index    levelCount x PackIndexEntry { uint64 offset, uint32 size,
+//            uint32 CRC-32 of the record }
+//   records  one per level, anywhere after the index:
+//              LevelRecord (dimensions, player, exit, counts)
+//              rows * cols tile bytes, zero-padded to a multiple of 4
+//              enemyCount   x { int32 x, int32 y }
+//              powerupCount x { int32 x, int32 y }
+// Opening a pack checks only the header and the index size, so it costs
+// the same for ten levels or ten thousand; each record is checked when it
+// is loaded.
+const std::uint32_t PACK_VERSION = 1;
+
+struct PackHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t levelCount;
+    std::uint32_t reserved;
+    std::uint64_t indexOffset;
+};
+
+struct PackIndexEntry {
+    std::uint64_t offset;
+    std::uint32_t size;
+    std::uint32_t crc;
+};
+
+struct LevelRecord {
+    std::int32_t rows, cols;
+    std::int32_t playerX, playerY;
+    std::int32_t exitX, exitY;
+    std::int32_t enemyDelay;
+    std::uint32_t enemyCount, powerupCount;
+    std::uint32_t reserved;
+};
+
+// A mapped level pack.
+class LevelPack {
+public:
+    LevelPack();
+
+    // Map a pack; returns false (and stays closed) if it is not a valid one.
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return count_ > 0; }
+    int count() const { return count_; }
+
+    // Replace the game's maze and entities with level index (0-based) and
+    // start it afresh: score and moves are reset and game.level becomes
+    // index + 1. Fails without touching the game if the record is corrupt.
+    bool load(int index, Game &game) const;
+
+private:
+    MappedFile file_;
+    const unsigned char *index_;  // First PackIndexEntry inside the mapping.
+    int count_;
+};
+
+// Encode a game's maze and entities as a level record.
+void appendLevelRecord(const Game &game, std::vector<unsigned char> &out);
+
+// Write the given levels as a pack, replacing the file atomically.
+bool writeLevelPack(const std::string &path, const std::vector<Game> &levels);
+
+// Parse a hand-made map drawn in text, one line per row: '#' and '@' are
+// walls, ' ' or '.' floor, 'P' the player, 'E' the exit, 'X' an enemy and
+// '*' a powerup. Short lines are padded with floor. Needs exactly one P and
+// one E; on failure error says why and the game is untouched.
+bool parseMapText(const std::string &text, Game &game, std::string &error);
+
+#endif  // LEVELPACK_H
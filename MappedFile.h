@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is mapped with
+// mmap; elsewhere it is read into memory.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Map the file; returns false (and stays closed) on failure.
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const unsigned char *data_;
+    std::size_t size_;
+    bool mapped_;
+    std::vector<unsigned char> buffer_;  // Fallback storage when not mapped.
+};
+
+#endif  // MAPPEDFILE_H
@@ -0,0 +1,102 @@
+#include "Metrics.h"
+#include <cstdio>
+#include <cstring>
+
+// Bucket index: values below 4 get their own bucket; above that, the
+// highest set bit picks the octave and the next two bits the quarter.
+static int bucketFor(std::uint64_t value) {
+    if (value < 4)
+        return static_cast<int>(value);
+#if defined(__GNUC__) || defined(__clang__)
+    int msb = 63 - __builtin_clzll(value);
+#else
+    int msb = 0;
+    while (value >> (msb + 1))
+        msb++;
+#endif
+    return (msb - 1) * 4 + static_cast<int>((value >> (msb - 2)) & 3);
+}
+
+// Largest value that falls into a bucket.
+static std::uint64_t bucketLimit(int index) {
+    if (index < 4)
+        return static_cast<std::uint64_t>(index);
+    int msb = index / 4 + 1;
+    std::uint64_t low = static_cast<std::uint64_t>(4 + index % 4) << (msb - 2);
+    return low + (std::uint64_t(1) << (msb - 2)) - 1;
+}
+
+Histogram::Histogram() {
+    reset();
+}
+
+void Histogram::reset() {
+    std::memset(buckets_, 0, sizeof(buckets_));
+    count_ = total_ = max_ = 0;
+}
+
+void Histogram::record(std::uint64_t value) {
+    buckets_[bucketFor(value)]++;
+    count_++;
+    total_ += value;
+    if (value > max_)
+        max_ = value;
+}
+
+std::uint64_t Histogram::percentile(double q) const {
+    if (count_ == 0)
+        return 0;
+    std::uint64_t rank = static_cast<std::uint64_t>(q * count_ + 0.5);
+    if (rank < 1)
+        rank = 1;
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets_[i];
+        if (seen >= rank)
+            return bucketLimit(i) < max_ ? bucketLimit(i) : max_;
+    }
+    return max_;
+}
+
+const char *phaseName(Phase phase) {
+    switch (phase) {
+    case PHASE_INPUT:     return "input wait";
+    case PHASE_PLAYER:    return "player move";
+    case PHASE_POWERUP:   return "powerup";
+    case PHASE_ENEMIES:   return "enemy update";
+    case PHASE_COLLISION: return "collision";
+    case PHASE_RENDER:    return "render";
+    case PHASE_OUTPUT:    return "output";
+    default:              return "?";
+    }
+}
+
+FrameMetrics::FrameMetrics() {}
+
+void FrameMetrics::reset() {
+    for (Histogram &h : phases_)
+        h.reset();
+    frameBytes_.reset();
+}
+
+void FrameMetrics::print(std::ostream &out) const {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-13s %8s %10s %10s %10s %10s\n",
+                  "phase (us)", "count", "mean", "p50", "p99", "max");
+    out << line;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const Histogram &h = phases_[i];
+        std::snprintf(line, sizeof(line), "%-13s %8llu %10.1f %10.1f %10.1f %10.1f\n",
+                      phaseName(static_cast<Phase>(i)), static_cast<unsigned long long>(h.count()),
+                      h.mean() / 1000.0, h.percentile(0.5) / 1000.0,
+                      h.percentile(0.99) / 1000.0, h.max() / 1000.0);
+        out << line;
+    }
+    const Histogram &b = frameBytes_;
+    std::snprintf(line, sizeof(line), "%-13s %8llu %10.0f %10llu %10llu %10llu\n",
+                  "bytes/frame", static_cast<unsigned long long>(b.count()), b.mean(),
+                  static_cast<unsigned long long>(b.percentile(0.5)),
+                  static_cast<unsigned long long>(b.percentile(0.99)),
+                  static_cast<unsigned long long>(b.max()));
+    out << line;
+}
@@ -0,0 +1,80 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Nanoseconds on the monotonic clock.
+inline std::uint64_t monotonicNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Fixed-bucket histogram of non-negative values (nanoseconds, bytes). Each
+// power of two is split into four buckets, so percentiles are within 25%
+// and recording is a few instructions with no allocation.
+class Histogram {
+public:
+    static const int BUCKETS = 252;
+
+    Histogram();
+    void record(std::uint64_t value);
+    void reset();
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(total_) / count_ : 0.0; }
+    // Upper bound of the bucket holding the q-th quantile (0 < q <= 1).
+    std::uint64_t percentile(double q) const;
+
+private:
+    std::uint64_t buckets_[BUCKETS];
+    std::uint64_t count_;
+    std::uint64_t total_;
+    std::uint64_t max_;
+};
+
+// Parts of a frame timed separately.
+enum Phase {
+    PHASE_INPUT,      // Waiting for a key (or for the next tick).
+    PHASE_PLAYER,     // Moving the player.
+    PHASE_POWERUP,    // Collecting a powerup.
+    PHASE_ENEMIES,    // Moving the enemies.
+    PHASE_COLLISION,  // Checking the player's cell after enemies move.
+    PHASE_RENDER,     // Drawing the frame, output included.
+    PHASE_OUTPUT,     // Terminal output: write() or the clear-screen system() call.
+    PHASE_COUNT
+};
+
+const char *phaseName(Phase phase);
+
+// Per-phase latency histograms and output counters for a session. Attach
+// one to Game::metrics and the renderer to have them filled in.
+class FrameMetrics {
+public:
+    FrameMetrics();
+
+    void record(Phase phase, std::uint64_t ns) { phases_[phase].record(ns); }
+    // Time from since to now into phase; returns now for chaining.
+    std::uint64_t lap(Phase phase, std::uint64_t since) {
+        std::uint64_t now = monotonicNs();
+        phases_[phase].record(now - since);
+        return now;
+    }
+    void recordFrameBytes(std::size_t bytes) { frameBytes_.record(bytes); }
+
+    const Histogram &phase(Phase phase) const { return phases_[phase]; }
+    const Histogram &frameBytes() const { return frameBytes_; }
+
+    void reset();
+    // Table of count, mean, p50, p99 and max per phase, then bytes per frame.
+    void print(std::ostream &out) const;
+
+private:
+    Histogram phases_[PHASE_COUNT];
+    Histogram frameBytes_;
+};
+
+#endif  // METRICS_H
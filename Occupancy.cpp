@@ -0,0 +1,19 @@
+#include "Occupancy.h"
+#include <cstddef>
+
+Occupancy::Occupancy() : cols_(0) {}
+
+void Occupancy::reset(int rows, int cols) {
+    cols_ = cols;
+    enemies_.assign(static_cast<std::size_t>(rows) * cols, 0);
+    powerups_.assign(static_cast<std::size_t>(rows) * cols, -1);
+}
+
+void Occupancy::rebuild(int rows, int cols, const EnemyList &enemies,
+                        const std::vector<Position> &powerups) {
+    reset(rows, cols);
+    for (size_t i = 0; i < enemies.size(); i++)
+        addEnemy(enemies[i]);
+    for (size_t i = 0; i < powerups.size(); i++)
+        setPowerup(powerups[i], static_cast<int>(i));
+}
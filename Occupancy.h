@@ -0,0 +1,42 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <vector>
+#include "Entity.h"
+
+// Per-cell index of what stands where: the number of enemies on each cell
+// and the index into Game::powerups of the powerup lying there (or -1).
+// Kept in sync with every entity move so lookups are O(1).
+class Occupancy {
+public:
+    Occupancy();
+
+    // Size for a rows x cols maze with nothing on it.
+    void reset(int rows, int cols);
+
+    // Rebuild from scratch for the given entities.
+    void rebuild(int rows, int cols, const EnemyList &enemies,
+                 const std::vector<Position> &powerups);
+
+    int enemiesAt(const Position &pos) const { return enemies_[index(pos)]; }
+    int powerupAt(const Position &pos) const { return powerups_[index(pos)]; }
+
+    void addEnemy(const Position &pos) { enemies_[index(pos)]++; }
+    void removeEnemy(const Position &pos) { enemies_[index(pos)]--; }
+    void moveEnemy(const Position &from, const Position &to) {
+        enemies_[index(from)]--;
+        enemies_[index(to)]++;
+    }
+
+    void setPowerup(const Position &pos, int id) { powerups_[index(pos)] = id; }
+    void clearPowerup(const Position &pos) { powerups_[index(pos)] = -1; }
+
+private:
+    int index(const Position &pos) const { return pos.x * cols_ + pos.y; }
+
+    int cols_;
+    std::vector<int> enemies_;
+    std::vector<int> powerups_;
+};
+
+#endif  // OCCUPANCY_H
@@ -0,0 +1,137 @@
+// Builds and inspects level packs (see LevelPack.h).
+//
+//   runwithmind_pack build OUT [--generate N] [--level L] [--seed S]
+//                              [--size RxC] [--threads T] [MAP.txt ...]
+//   runwithmind_pack list PACK
+//
+// build writes the hand-made maps given as text files first, in order,
+// followed by N generated maps that passed the reachability check.
+#include "Game.h"
+#include "LevelGenerator.h"
+#include "LevelPack.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static void usage(const char *program) {
+    std::cout << "Usage: " << program << " build OUT [options] [MAP.txt ...]\n"
+              << "       " << program << " list PACK\n"
+              << "  --generate N     append N generated maps\n"
+              << "  --level L        level to generate (default 1)\n"
+              << "  --seed N         seed of the first generated map (default 1)\n"
+              << "  --size RxC       generated maze rows and columns (default 20x20)\n"
+              << "  --threads T      worker threads for generation (default: all cores)\n"
+              << "Map files use '#' and '@' for walls, ' ' or '.' for floor, and P, E, X\n"
+              << "and * for the player, exit, enemies and powerups.\n";
+}
+
+static bool readMap(const std::string &path, Game &game) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot read " << path << std::endl;
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    std::string error;
+    if (!parseMapText(text.str(), game, error)) {
+        std::cerr << path << ": " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static int build(int argc, char *argv[]) {
+    if (argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::string out = argv[2];
+    int generate = 0, level = 1, rows = DEFAULT_ROWS, cols = DEFAULT_COLS, threads = 0;
+    std::uint64_t seed = 1;
+    std::vector<Game> levels;
+    for (int i = 3; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--generate") == 0 && hasValue) {
+            generate = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--level") == 0 && hasValue) {
+            level = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue &&
+                   std::sscanf(argv[i + 1], "%dx%d", &rows, &cols) == 2) {
+            i++;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = std::atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            Game game;
+            if (!readMap(argv[i], game))
+                return 1;
+            levels.push_back(game);
+        }
+    }
+    int handMade = static_cast<int>(levels.size());
+    if (generate > 0) {
+        std::vector<Game> maps;
+        generateLevels(maps, generate, level, seed, threads, 1000, rows, cols);
+        levels.insert(levels.end(), maps.begin(), maps.end());
+    }
+    if (levels.empty()) {
+        std::cerr << "No levels to write." << std::endl;
+        return 1;
+    }
+    if (!writeLevelPack(out, levels)) {
+        std::cerr << "Cannot write " << out << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << levels.size() << " levels (" << handMade << " hand-made, "
+              << levels.size() - handMade << " generated) to " << out << std::endl;
+    return 0;
+}
+
+static int list(int argc, char *argv[]) {
+    if (argc != 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    LevelPack pack;
+    if (!pack.open(argv[2])) {
+        std::cerr << "Cannot open level pack " << argv[2] << std::endl;
+        return 1;
+    }
+    double openUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << argv[2] << ": " << pack.count() << " levels, opened in " << openUs << " us\n";
+    int corrupt = 0;
+    Game game;
+    for (int i = 0; i < pack.count(); i++) {
+        if (!pack.load(i, game)) {
+            std::cout << "  " << i + 1 << ": corrupt\n";
+            corrupt++;
+            continue;
+        }
+        std::cout << "  " << i + 1 << ": " << game.grid.rows() << "x" << game.grid.cols() << ", "
+                  << game.enemies.size() << " enemies, " << game.powerups.size() << " powerups\n";
+    }
+    std::cout.flush();
+    return corrupt == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 2 && std::strcmp(argv[1], "build") == 0)
+        return build(argc, argv);
+    if (argc >= 2 && std::strcmp(argv[1], "list") == 0)
+        return list(argc, argv);
+    usage(argv[0]);
+    return 1;
+}
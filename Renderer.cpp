@@ -0,0 +1,212 @@
+#include "Renderer.h"
+#include "Game.h"
+#include "Metrics.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+
+Renderer::Renderer() : metrics_(nullptr) {}
+
+Renderer::~Renderer() {}
+
+void Renderer::invalidate() {}
+
+// Terminal renderer
+void TerminalRenderer::render(const Game &game) {
+    std::uint64_t t = metrics_ ? monotonicNs() : 0;
+#ifdef _WIN32
+    system("cls");
+#else
+    system("clear");
+#endif
+    if (metrics_)
+        metrics_->lap(PHASE_OUTPUT, t);
+    printGrid(game);
+}
+
+void TerminalRenderer::message(const std::string &text) {
+    std::cout << text << std::endl;
+}
+
+// Null renderer
+void NullRenderer::render(const Game &) {}
+
+void NullRenderer::message(const std::string &) {}
+
+// Frame buffer renderer
+
+// Escape sequence for each FrameBufferRenderer::Color. Each one resets the
+// previous attributes first so switching never leaks a background color.
+static const char *const COLOR_CODES[] = {
+    "\033[0m",       // COLOR_DEFAULT
+    "\033[0;1;31m",  // COLOR_RED
+    "\033[0;1;32m",  // COLOR_GREEN
+    "\033[0;1;33m",  // COLOR_YELLOW
+    "\033[0;1;34m",  // COLOR_BLUE
+    "\033[0;1;35m",  // COLOR_MAGENTA
+    "\033[0;47m",    // COLOR_BG_WHITE
+    "\033[0;100m"    // COLOR_BG_GRAY
+};
+
+static const char *const BANNER = "=====================================";
+static const char *const TITLE = "        Run with Mind";
+static const char *const CONTROLS = "Controls: WASD to move, 'R' rewind, 'M' menu (save/load), 'T' timings.";
+
+FrameBufferRenderer::FrameBufferRenderer(int fd)
+    : fd_(fd), width_(0), height_(0), messageRow_(0),
+      fullRedraw_(true), lastFrameBytes_(0) {}
+
+void FrameBufferRenderer::resize(int width, int height) {
+    if (width == width_ && height == height_)
+        return;
+    width_ = width;
+    height_ = height;
+    next_.assign(static_cast<size_t>(width) * height, Cell{' ', COLOR_DEFAULT});
+    shown_ = next_;
+    fullRedraw_ = true;
+}
+
+void FrameBufferRenderer::clearRow(int row) {
+    for (int j = 0; j < width_; j++)
+        next_[row * width_ + j] = Cell{' ', COLOR_DEFAULT};
+}
+
+void FrameBufferRenderer::putText(int row, const std::string &text, unsigned char color) {
+    clearRow(row);
+    for (int j = 0; j < width_ && j < static_cast<int>(text.size()); j++)
+        next_[row * width_ + j] = Cell{text[j], color};
+}
+
+// Lay out the same screen printGrid() produces: banner, the part of the
+// maze around the player that fits the terminal, statistics, controls and a
+// message line. The cost depends on the terminal size, not the map size.
+void FrameBufferRenderer::compose(const Game &game) {
+    const int headerRows = 3;
+    int termRows, termCols;
+    terminalSize(termRows, termCols);
+    Viewport view = viewportAround(game.grid, game.player.pos,
+                                   termRows - SCREEN_CHROME_ROWS, termCols);
+    int width = static_cast<int>(std::char_traits<char>::length(CONTROLS));
+    width = std::min(std::max(width, view.cols), termCols);
+    resize(width, headerRows + view.rows + 3);
+    messageRow_ = headerRows + view.rows + 2;
+
+    putText(0, BANNER, COLOR_YELLOW);
+    putText(1, TITLE, COLOR_YELLOW);
+    putText(2, BANNER, COLOR_YELLOW);
+
+    for (int r = 0; r < view.rows; r++) {
+        Cell *line = &next_[(headerRows + r) * width_];
+        int i = view.top + r;
+        for (int c = 0; c < view.cols; c++) {
+            int j = view.left + c;
+            Position pos = {i, j};
+            Tile cell = game.grid.at(i, j);
+            if (i == game.player.pos.x && j == game.player.pos.y)
+                line[c] = Cell{game.player.getSymbol(), COLOR_GREEN};
+            else if (game.occupancy.enemiesAt(pos) > 0)
+                line[c] = Cell{'X', COLOR_RED};
+            else if (game.occupancy.powerupAt(pos) >= 0)
+                line[c] = Cell{'*', COLOR_YELLOW};
+            else if (cell == Tile::Floor)
+                line[c] = Cell{' ', static_cast<unsigned char>((i + j) % 2 == 0 ? COLOR_BG_WHITE : COLOR_BG_GRAY)};
+            else if (tileBlocks(cell))
+                line[c] = Cell{tileToChar(cell), COLOR_BLUE};
+            else
+                line[c] = Cell{tileToChar(cell), COLOR_MAGENTA};
+        }
+        for (int c = view.cols; c < width_; c++)
+            line[c] = Cell{' ', COLOR_DEFAULT};
+    }
+
+    putText(headerRows + view.rows, "Score: " + std::to_string(game.score) +
+            "   Level: " + std::to_string(game.level) +
+            "   Moves: " + std::to_string(game.totalMoves), COLOR_DEFAULT);
+    putText(headerRows + view.rows + 1, CONTROLS, COLOR_DEFAULT);
+    clearRow(messageRow_);
+}
+
+// Emit the difference between next_ and shown_ in a single write.
+void FrameBufferRenderer::flush() {
+    char seq[32];
+    out_.clear();
+    if (fullRedraw_)
+        out_ += "\033[H\033[2J";
+
+    int color = -1;
+    int curRow = -1, curCol = -1;
+    for (int i = 0; i < height_; i++) {
+        for (int j = 0; j < width_; j++) {
+            const Cell &cell = next_[i * width_ + j];
+            if (!fullRedraw_ && cell == shown_[i * width_ + j])
+                continue;
+            if (i != curRow || j != curCol) {
+                snprintf(seq, sizeof(seq), "\033[%d;%dH", i + 1, j + 1);
+                out_ += seq;
+            }
+            if (cell.color != color) {
+                out_ += COLOR_CODES[cell.color];
+                color = cell.color;
+            }
+            out_ += cell.ch;
+            curRow = i;
+            curCol = j + 1;
+        }
+    }
+    if (color != COLOR_DEFAULT && color != -1)
+        out_ += COLOR_CODES[COLOR_DEFAULT];
+    // Park the cursor below the frame so other output lands there.
+    snprintf(seq, sizeof(seq), "\033[%d;1H", height_ + 1);
+    out_ += seq;
+
+    // Keep ordering with anything still buffered in std::cout.
+    std::uint64_t t = metrics_ ? monotonicNs() : 0;
+    std::cout.flush();
+#ifdef _WIN32
+    fwrite(out_.data(), 1, out_.size(), stdout);
+    fflush(stdout);
+#else
+    const char *data = out_.data();
+    size_t left = out_.size();
+    while (left > 0) {
+        ssize_t n = write(fd_, data, left);
+        if (n < 0) {
+            perror("write()");
+            break;
+        }
+        data += n;
+        left -= static_cast<size_t>(n);
+    }
+#endif
+    lastFrameBytes_ = out_.size();
+    if (metrics_) {
+        metrics_->lap(PHASE_OUTPUT, t);
+        metrics_->recordFrameBytes(lastFrameBytes_);
+    }
+    shown_ = next_;
+    fullRedraw_ = false;
+}
+
+void FrameBufferRenderer::render(const Game &game) {
+    compose(game);
+    flush();
+}
+
+void FrameBufferRenderer::message(const std::string &text) {
+    if (height_ == 0) {
+        std::cout << text << std::endl;
+        return;
+    }
+    putText(messageRow_, text, COLOR_DEFAULT);
+    flush();
+}
+
+void FrameBufferRenderer::invalidate() {
+    fullRedraw_ = true;
+}
@@ -0,0 +1,87 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <string>
+#include <vector>
+
+struct Game;
+class FrameMetrics;
+
+// Interface for anything that presents game frames to the player.
+class Renderer {
+public:
+    Renderer();
+    virtual ~Renderer();
+    // Draw the current state of the game.
+    virtual void render(const Game &game) = 0;
+    // Show a one-line status message below the last frame.
+    virtual void message(const std::string &text) = 0;
+    // Forget what is on screen so the next frame is drawn in full
+    // (called after something else has written to the terminal).
+    virtual void invalidate();
+    // Time terminal output into the given metrics (not owned; may be null).
+    void setMetrics(FrameMetrics *metrics) { metrics_ = metrics; }
+
+protected:
+    FrameMetrics *metrics_;
+};
+
+// Clears the terminal and redraws the whole maze with printGrid().
+class TerminalRenderer : public Renderer {
+public:
+    virtual void render(const Game &game) override;
+    virtual void message(const std::string &text) override;
+};
+
+// Discards all output; used for headless simulation.
+class NullRenderer : public Renderer {
+public:
+    virtual void render(const Game &game) override;
+    virtual void message(const std::string &text) override;
+};
+
+// Composes each frame in memory and writes only the cells that changed
+// since the previous frame, using cursor-positioning escapes and one
+// write() per frame. Runs of the same color share a single escape.
+class FrameBufferRenderer : public Renderer {
+public:
+    explicit FrameBufferRenderer(int fd = 1);
+    virtual void render(const Game &game) override;
+    virtual void message(const std::string &text) override;
+    virtual void invalidate() override;
+    // Number of bytes emitted for the most recent frame.
+    size_t lastFrameBytes() const { return lastFrameBytes_; }
+
+    // Colors a cell can be drawn in.
+    enum Color : unsigned char {
+        COLOR_DEFAULT, COLOR_RED, COLOR_GREEN, COLOR_YELLOW, COLOR_BLUE,
+        COLOR_MAGENTA, COLOR_BG_WHITE, COLOR_BG_GRAY
+    };
+
+private:
+    struct Cell {
+        char ch;
+        unsigned char color;
+        bool operator==(const Cell &other) const {
+            return ch == other.ch && color == other.color;
+        }
+    };
+
+    void compose(const Game &game);
+    void resize(int width, int height);
+    void putText(int row, const std::string &text, unsigned char color);
+    void clearRow(int row);
+    void flush();
+
+    int fd_;
+    int width_;
+    int height_;
+    int messageRow_;
+    std::vector<Cell> next_;   // Frame being composed.
+    std::vector<Cell> shown_;  // Frame currently on screen.
+    bool fullRedraw_;
+    std::string out_;          // Reused output buffer.
+    size_t lastFrameBytes_;
+};
+
+#endif  // RENDERER_H
@@ -0,0 +1,322 @@
+#include "Replay.h"
+#include "Renderer.h"
+#include "SaveBinary.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+int replayStep(Game &game, Action action) {
+    int outcome = stepGame(game, action);
+    if ((outcome & STEP_EXIT) && !(outcome & STEP_CAUGHT) && game.level == 1)
+        initLevel(game, 2, game.grid.rows(), game.grid.cols());
+    return outcome;
+}
+
+// Recorder
+
+ReplayRecorder::ReplayRecorder()
+    : keyframeInterval(64), file_(nullptr), offset_(0), moves_(0), lastKeyframe_(0) {}
+
+ReplayRecorder::~ReplayRecorder() {
+    if (file_)
+        std::fclose(file_);
+}
+
+void ReplayRecorder::write(const void *data, std::size_t size) {
+    std::fwrite(data, 1, size, file_);
+    offset_ += size;
+}
+
+bool ReplayRecorder::begin(const std::string &path, unsigned int seed, const Game &game) {
+    if (file_)
+        std::fclose(file_);
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+        return false;
+    offset_ = 0;
+    moves_ = 0;
+    index_.clear();
+
+    std::uint32_t seed32 = seed;
+    std::int32_t level = game.level;
+    std::int32_t pursuit = static_cast<std::int32_t>(game.pursuit);
+    write("RWMR", 4);
+    write(&REPLAY_VERSION, 4);
+    write(&seed32, 4);
+    write(&level, 4);
+    write(&pursuit, 4);
+    keyframe(game);
+    return true;
+}
+
+void ReplayRecorder::keyframe(const Game &game) {
+    if (!file_)
+        return;
+    serializeGame(game, image_);
+    std::uint32_t size = static_cast<std::uint32_t>(image_.size());
+    index_.push_back(std::make_pair(moves_, offset_));
+    write("K", 1);
+    write(&moves_, 4);
+    write(&size, 4);
+    write(image_.data(), image_.size());
+    std::fflush(file_);
+    lastKeyframe_ = moves_;
+}
+
+void ReplayRecorder::record(Action action, const Game &game) {
+    if (!file_)
+        return;
+    unsigned char chunk[2] = {'A', static_cast<unsigned char>(action)};
+    write(chunk, 2);
+    moves_++;
+    if (moves_ - lastKeyframe_ >= keyframeInterval)
+        keyframe(game);
+}
+
+void ReplayRecorder::finish(const Game &game) {
+    if (!file_)
+        return;
+    if (lastKeyframe_ != moves_ || index_.empty())
+        keyframe(game);
+    std::uint64_t indexOffset = offset_;
+    std::uint32_t count = static_cast<std::uint32_t>(index_.size());
+    write("I", 1);
+    write(&count, 4);
+    for (const auto &entry : index_) {
+        write(&entry.first, 4);
+        write(&entry.second, 8);
+    }
+    write(&moves_, 4);
+    write(&indexOffset, 8);
+    write("RWMI", 4);
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+// Reader
+
+ReplayReader::ReplayReader()
+    : seed_(0), level_(1), pursuit_(PursuitMode::Greedy), moves_(0), end_(0) {}
+
+// Offset after the keyframe at off, or end_ if it does not fit.
+std::size_t ReplayReader::skipKeyframe(std::size_t off) const {
+    if (off + 9 > end_)
+        return end_;
+    std::uint32_t size;
+    std::memcpy(&size, file_.data() + off + 5, 4);
+    return size > end_ - off - 9 ? end_ : off + 9 + size;
+}
+
+// Whether every index entry points at a whole keyframe inside the chunk
+// area, in order of move as seek() expects.
+bool ReplayReader::validIndex() const {
+    const unsigned char *data = file_.data();
+    for (std::size_t i = 0; i < index_.size(); i++) {
+        std::uint64_t off = index_[i].second;
+        if (off < headerSize() || off + 9 > end_ || data[off] != 'K')
+            return false;
+        std::uint32_t length;
+        std::memcpy(&length, data + off + 5, 4);
+        if (length > end_ - off - 9)
+            return false;
+        if (i > 0 && index_[i].first < index_[i - 1].first)
+            return false;
+    }
+    return !index_.empty();
+}
+
+// Rebuild the index of a replay that has no footer.
+bool ReplayReader::scan() {
+    const unsigned char *data = file_.data();
+    std::size_t size = file_.size();
+    index_.clear();
+    moves_ = 0;
+    std::size_t off = headerSize();
+    while (off < size) {
+        if (data[off] == 'A' && off + 2 <= size &&
+            data[off + 1] <= static_cast<unsigned char>(Action::Right)) {
+            moves_++;
+            off += 2;
+        } else if (data[off] == 'K' && off + 9 <= size) {
+            std::uint32_t move, length;
+            std::memcpy(&move, data + off + 1, 4);
+            std::memcpy(&length, data + off + 5, 4);
+            if (length > size - off - 9)
+                break;  // Torn keyframe.
+            index_.push_back(std::make_pair(move, static_cast<std::uint64_t>(off)));
+            off += 9 + length;
+        } else {
+            break;
+        }
+    }
+    end_ = off;
+    return !index_.empty();
+}
+
+bool ReplayReader::open(const std::string &path) {
+    if (!file_.open(path) || file_.size() < headerSize() ||
+        std::memcmp(file_.data(), "RWMR", 4) != 0)
+        return false;
+    const unsigned char *data = file_.data();
+    std::uint32_t version, seed;
+    std::int32_t level, pursuit;
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&seed, data + 8, 4);
+    std::memcpy(&level, data + 12, 4);
+    std::memcpy(&pursuit, data + 16, 4);
+    if (version != REPLAY_VERSION)
+        return false;
+    seed_ = seed;
+    level_ = level;
+    pursuit_ = pursuit == static_cast<std::int32_t>(PursuitMode::FlowField)
+                   ? PursuitMode::FlowField : PursuitMode::Greedy;
+
+    // Use the footer's index when the recording was finished cleanly.
+    std::size_t size = file_.size();
+    if (size >= headerSize() + 16 && std::memcmp(data + size - 4, "RWMI", 4) == 0) {
+        std::uint64_t indexOffset;
+        std::uint32_t count;
+        std::memcpy(&moves_, data + size - 16, 4);
+        std::memcpy(&indexOffset, data + size - 12, 8);
+        if (indexOffset + 5 <= size && data[indexOffset] == 'I') {
+            std::memcpy(&count, data + indexOffset + 1, 4);
+            if (indexOffset + 5 + 12ull * count + 16 == size) {
+                index_.resize(count);
+                for (std::uint32_t i = 0; i < count; i++) {
+                    const unsigned char *entry = data + indexOffset + 5 + 12 * i;
+                    std::memcpy(&index_[i].first, entry, 4);
+                    std::memcpy(&index_[i].second, entry + 4, 8);
+                }
+                end_ = static_cast<std::size_t>(indexOffset);
+                if (validIndex())
+                    return true;
+            }
+        }
+    }
+    // No footer, or one that cannot be trusted.
+    return scan();
+}
+
+bool ReplayReader::seek(Game &game, std::uint32_t move) const {
+    if (index_.empty())
+        return false;
+    move = std::min(move, moves_);
+    // Last keyframe at or before the requested move; with two keyframes at
+    // the same move (level change) this picks the later one.
+    auto it = std::upper_bound(index_.begin(), index_.end(), std::make_pair(move, ~0ull),
+                               [](const std::pair<std::uint32_t, std::uint64_t> &a,
+                                  const std::pair<std::uint32_t, std::uint64_t> &b) {
+                                   return a.first < b.first;
+                               });
+    if (it == index_.begin())
+        return false;
+    --it;
+    std::size_t off = static_cast<std::size_t>(it->second);
+    std::uint32_t length;
+    std::memcpy(&length, file_.data() + off + 5, 4);
+    if (!deserializeGame(game, file_.data() + off + 9, length))
+        return false;
+
+    std::uint32_t at = it->first;
+    off += 9 + length;
+    while (at < move && off < end_) {
+        if (isAction(off)) {
+            replayStep(game, static_cast<Action>(file_.data()[off + 1]));
+            at++;
+            off += 2;
+        } else if (file_.data()[off] == 'K') {
+            off = skipKeyframe(off);
+        } else {
+            break;
+        }
+    }
+    return at == move;
+}
+
+bool verifyReplay(const std::string &path) {
+    ReplayReader reader;
+    if (!reader.open(path)) {
+        std::cout << "Cannot read replay " << path << std::endl;
+        return false;
+    }
+
+    Game start;
+    if (!reader.seek(start, 0)) {
+        std::cout << "Replay has no initial keyframe." << std::endl;
+        return false;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    Game game;
+    game.rng.seed(reader.seed());
+    game.pursuit = reader.pursuit();
+    initLevel(game, reader.level(), start.grid.rows(), start.grid.cols());
+
+    std::vector<unsigned char> expected, actual;
+    serializeGame(start, expected);
+    serializeGame(game, actual);
+    if (expected != actual) {
+        std::cout << "Level generated from seed " << reader.seed()
+                  << " does not match the recording." << std::endl;
+        return false;
+    }
+
+    std::uint32_t moves = 0;
+    reader.forEachAction([&](Action action) {
+        replayStep(game, action);
+        moves++;
+    });
+    auto end = std::chrono::steady_clock::now();
+
+    Game recorded;
+    reader.seek(recorded, reader.moveCount());
+    serializeGame(recorded, expected);
+    serializeGame(game, actual);
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    std::cout << "Replayed " << moves << " moves in " << seconds * 1000.0 << " ms";
+    if (seconds > 0)
+        std::cout << " (" << static_cast<long long>(moves / seconds) << " moves/s)";
+    std::cout << std::endl;
+    if (expected != actual) {
+        std::cout << "Final state differs from the recording." << std::endl;
+        return false;
+    }
+    std::cout << "Final state matches (score " << game.score << ", moves "
+              << game.totalMoves << ")." << std::endl;
+    return true;
+}
+
+void viewReplay(const std::string &path) {
+    ReplayReader reader;
+    if (!reader.open(path)) {
+        std::cout << "Cannot read replay " << path << std::endl;
+        return;
+    }
+    FrameBufferRenderer renderer;
+    Game game;
+    std::uint32_t move = 0;
+    const std::uint32_t jump = 64;
+    while (true) {
+        if (!reader.seek(game, move)) {
+            std::cout << "Cannot seek to move " << move << std::endl;
+            return;
+        }
+        renderer.render(game);
+        renderer.message("Replay move " + std::to_string(move) + "/" +
+                         std::to_string(reader.moveCount()) +
+                         "  n/p: step  f/b: jump 64  q: quit");
+        char key = getInputChar();
+        if (key == 'n' || key == 'N')
+            move = std::min(move + 1, reader.moveCount());
+        else if (key == 'p' || key == 'P')
+            move = move > 0 ? move - 1 : 0;
+        else if (key == 'f' || key == 'F')
+            move = std::min(move + jump, reader.moveCount());
+        else if (key == 'b' || key == 'B')
+            move = move > jump ? move - jump : 0;
+        else if (key == 'q' || key == 'Q' || key == 0)
+            break;
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Game.h"
+#include "MappedFile.h"
+
+// Replay file, integers in native byte order like the keyframe images:
+//   header    "RWMR", uint32 version, uint32 seed, int32 level, int32 pursuit
+//   chunks    'A' uint8 action               one per stepGame() call
+//             'K' uint32 move, uint32 size, binary save image (SaveBinary.h)
+//   index     'I' uint32 count, count x { uint32 move, uint64 offset }
+//   footer    uint32 moves, uint64 index offset, "RWMI"
+// A keyframe is written at move 0, every keyframeInterval moves, right after
+// each level change and at the end. A file cut short by a crash has no
+// footer; readers then rebuild the index by scanning the chunks.
+const std::uint32_t REPLAY_VERSION = 2;  // 2: seeds drive Game::rng, not rand().
+
+// Advance a replayed game by one recorded action, including the move to
+// level 2 that runGame() performs when level 1 is cleared.
+int replayStep(Game &game, Action action);
+
+// Records a session's actions and periodic keyframes.
+class ReplayRecorder {
+public:
+    ReplayRecorder();
+    ~ReplayRecorder();
+
+    // Start a recording for a game generated from seed.
+    bool begin(const std::string &path, unsigned int seed, const Game &game);
+
+    // Append an action that has just been applied to game.
+    void record(Action action, const Game &game);
+
+    // Write a keyframe of the current state (e.g. after a level change).
+    void keyframe(const Game &game);
+
+    // Write the final keyframe, index and footer, and close the file.
+    void finish(const Game &game);
+
+    bool isActive() const { return file_ != nullptr; }
+
+    std::uint32_t keyframeInterval;  // Moves between keyframes (default 64).
+
+private:
+    void write(const void *data, std::size_t size);
+
+    std::FILE *file_;
+    std::uint64_t offset_;
+    std::uint32_t moves_;
+    std::uint32_t lastKeyframe_;
+    std::vector<std::pair<std::uint32_t, std::uint64_t> > index_;
+    std::vector<unsigned char> image_;
+};
+
+// Random access to a recorded replay.
+class ReplayReader {
+public:
+    ReplayReader();
+
+    bool open(const std::string &path);
+
+    unsigned int seed() const { return seed_; }
+    int level() const { return level_; }
+    PursuitMode pursuit() const { return pursuit_; }
+    std::uint32_t moveCount() const { return moves_; }
+    std::size_t keyframeCount() const { return index_.size(); }
+
+    // Reconstruct the state after the given number of moves: binary-search
+    // the nearest earlier keyframe, then re-simulate the moves after it.
+    bool seek(Game &game, std::uint32_t move) const;
+
+    // Call fn(action) for every recorded action in order.
+    template <typename Fn>
+    void forEachAction(Fn fn) const {
+        for (std::size_t off = headerSize(); off < end_;) {
+            if (isAction(off)) {
+                fn(static_cast<Action>(file_.data()[off + 1]));
+                off += 2;
+            } else if (file_.data()[off] == 'K') {
+                off = skipKeyframe(off);
+            } else {
+                break;
+            }
+        }
+    }
+
+private:
+    static std::size_t headerSize() { return 20; }
+    // Whether a complete action chunk with a known action starts at off.
+    bool isAction(std::size_t off) const {
+        return file_.data()[off] == 'A' && off + 2 <= end_ &&
+               file_.data()[off + 1] <= static_cast<unsigned char>(Action::Right);
+    }
+    std::size_t skipKeyframe(std::size_t off) const;
+    bool validIndex() const;
+    bool scan();
+
+    MappedFile file_;
+    unsigned int seed_;
+    int level_;
+    PursuitMode pursuit_;
+    std::uint32_t moves_;
+    std::size_t end_;  // End of the chunk area.
+    std::vector<std::pair<std::uint32_t, std::uint64_t> > index_;
+};
+
+// Re-simulate a replay from its seed at full speed and check that the
+// result matches the recorded final keyframe. Prints a short report.
+bool verifyReplay(const std::string &path);
+
+// Step through a replay on the terminal.
+void viewReplay(const std::string &path);
+
+#endif  // REPLAY_H
@@ -0,0 +1,58 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// Small, fast random number generator (PCG32, XSH-RR variant) owned by each
+// Game, so level generation is reproducible from a seed and games on
+// different threads never share state.
+class Rng {
+public:
+    Rng() { seed(0); }
+    explicit Rng(std::uint64_t s) { seed(s); }
+
+    void seed(std::uint64_t s, std::uint64_t stream = 0xda3e39cb94b95bdbULL) {
+        state_ = 0;
+        inc_ = (stream << 1) | 1u;
+        next();
+        state_ += s;
+        next();
+    }
+
+    // Uniform 32-bit value.
+    std::uint32_t next() {
+        std::uint64_t old = state_;
+        state_ = old * 6364136223846793005ULL + inc_;
+        std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+        std::uint32_t rot = static_cast<std::uint32_t>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // Uniform value in [0, bound) without modulo bias (Lemire's method).
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t m = static_cast<std::uint64_t>(next()) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(m);
+        if (low < bound) {
+            std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                m = static_cast<std::uint64_t>(next()) * bound;
+                low = static_cast<std::uint32_t>(m);
+            }
+        }
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+
+    // Raw generator state, for saving and restoring.
+    std::uint64_t state() const { return state_; }
+    std::uint64_t increment() const { return inc_; }
+    void setState(std::uint64_t state, std::uint64_t increment) {
+        state_ = state;
+        inc_ = increment | 1u;
+    }
+
+private:
+    std::uint64_t state_;
+    std::uint64_t inc_;
+};
+
+#endif  // RNG_H
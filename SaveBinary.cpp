@@ -0,0 +1,287 @@
+#include "SaveBinary.h"
+#include "Game.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+#include "Utils.h"
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+// Table for the reflected IEEE polynomial. It is filled in the constructor
+// of a function-local static, so the first use is safe from any thread.
+static const std::uint32_t *crcTable() {
+    struct Table {
+        std::uint32_t entries[256];
+
+        Table() {
+            for (std::uint32_t i = 0; i < 256; i++) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[i] = c;
+            }
+        }
+    };
+    static const Table table;
+    return table.entries;
+}
+
+std::uint32_t crc32(const void *data, std::size_t size, std::uint32_t crc) {
+    const std::uint32_t *table = crcTable();
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; i++)
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Bytes used by a blob once padded so the entity arrays stay aligned.
+static std::size_t padded(std::size_t n) {
+    return (n + 3) & ~static_cast<std::size_t>(3);
+}
+
+static void appendBytes(std::vector<unsigned char> &out, const void *data, std::size_t size) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    out.insert(out.end(), p, p + size);
+}
+
+// Longest run a single byte holds; longer ones are followed by a varint.
+static const std::size_t SHORT_RUN = 63;
+
+// Append the run-length encoding of cells tile bytes. Mazes are mostly
+// floor with walls in short runs and long border rows, so this is a few
+// times smaller than the raw bytes, and never larger.
+static void encodeTiles(const unsigned char *tiles, std::size_t cells,
+                        std::vector<unsigned char> &out) {
+    std::size_t i = 0;
+    while (i < cells) {
+        unsigned char tile = tiles[i];
+        std::size_t run = 1;
+        while (i + run < cells && tiles[i + run] == tile)
+            run++;
+        i += run;
+        if (run <= SHORT_RUN) {
+            out.push_back(static_cast<unsigned char>(tile | ((run - 1) << 2)));
+            continue;
+        }
+        out.push_back(static_cast<unsigned char>(tile | (SHORT_RUN << 2)));
+        std::size_t extra = run - SHORT_RUN - 1;
+        while (extra >= 0x80) {
+            out.push_back(static_cast<unsigned char>(extra | 0x80));
+            extra >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(extra));
+    }
+}
+
+// Decode a run-length encoded blob into cells tile bytes. Fails unless the
+// runs cover the grid exactly.
+static bool decodeTiles(const unsigned char *data, std::size_t size,
+                        unsigned char *tiles, std::size_t cells) {
+    std::size_t at = 0, filled = 0;
+    while (at < size) {
+        unsigned char byte = data[at++];
+        // Every 2-bit value is a valid tile.
+        unsigned char tile = byte & 3;
+        std::size_t run = static_cast<std::size_t>(byte >> 2) + 1;
+        if (run > SHORT_RUN) {
+            std::size_t extra = 0;
+            for (int shift = 0;; shift += 7) {
+                if (at >= size || shift > 21)
+                    return false;
+                unsigned char b = data[at++];
+                extra |= static_cast<std::size_t>(b & 0x7F) << shift;
+                if (!(b & 0x80))
+                    break;
+            }
+            run += extra;
+        }
+        if (run > cells - filled)
+            return false;
+        std::memset(tiles + filled, tile, run);
+        filled += run;
+    }
+    return filled == cells;
+}
+
+// Encode the state a Game and a GameSnapshot have in common; they differ
+// only in how the player's position is held.
+template <class State>
+static void encodeState(const State &state, const Position &player,
+                        std::vector<unsigned char> &out) {
+    SaveHeader header;
+    std::memcpy(header.magic, "RWMS", 4);
+    header.version = SAVE_VERSION;
+    header.rows = state.grid.rows();
+    header.cols = state.grid.cols();
+    header.level = state.level;
+    header.score = state.score;
+    header.moveCounter = state.moveCounter;
+    header.totalMoves = state.totalMoves;
+    header.enemyDelay = state.enemyDelay;
+    header.gameOver = state.gameOver ? 1 : 0;
+    header.pursuit = static_cast<std::int32_t>(state.pursuit);
+    header.playerX = player.x;
+    header.playerY = player.y;
+    header.exitX = state.exitPos.x;
+    header.exitY = state.exitPos.y;
+    header.enemyCount = static_cast<std::uint32_t>(state.enemies.size());
+    header.powerupCount = static_cast<std::uint32_t>(state.powerups.size());
+    header.rngState[0] = static_cast<std::uint32_t>(state.rng.state());
+    header.rngState[1] = static_cast<std::uint32_t>(state.rng.state() >> 32);
+    header.rngInc[0] = static_cast<std::uint32_t>(state.rng.increment());
+    header.rngInc[1] = static_cast<std::uint32_t>(state.rng.increment() >> 32);
+    header.gridBytes = 0;
+
+    // The encoded grid is at most one byte per cell, so this is the most
+    // the image can need and reused buffers settle at once.
+    std::size_t cells = static_cast<std::size_t>(state.grid.size());
+    out.clear();
+    out.reserve(sizeof(header) + padded(cells) +
+                8 * (state.enemies.size() + state.powerups.size()) + 4);
+    appendBytes(out, &header, sizeof(header));
+    encodeTiles(state.grid.data(), cells, out);
+    header.gridBytes = static_cast<std::uint32_t>(out.size() - sizeof(header));
+    std::memcpy(out.data() + offsetof(SaveHeader, gridBytes), &header.gridBytes,
+                sizeof(header.gridBytes));
+    out.resize(sizeof(header) + padded(header.gridBytes), 0);
+    for (size_t i = 0; i < state.enemies.size(); i++) {
+        std::int32_t xy[2] = {state.enemies.xs()[i], state.enemies.ys()[i]};
+        appendBytes(out, xy, sizeof(xy));
+    }
+    for (const auto &p : state.powerups) {
+        std::int32_t xy[2] = {p.x, p.y};
+        appendBytes(out, xy, sizeof(xy));
+    }
+    std::uint32_t crc = crc32(out.data(), out.size());
+    appendBytes(out, &crc, sizeof(crc));
+}
+
+void serializeGame(const Game &game, std::vector<unsigned char> &out) {
+    encodeState(game, game.player.pos, out);
+}
+
+void serializeSnapshot(const GameSnapshot &snapshot, std::vector<unsigned char> &out) {
+    encodeState(snapshot, snapshot.player, out);
+}
+
+bool deserializeGame(Game &game, const unsigned char *data, std::size_t size) {
+    SaveHeader header;
+    std::size_t headerSize = offsetof(SaveHeader, rngState);
+    if (size < headerSize)
+        return false;
+    std::memcpy(&header, data, headerSize);
+    if (std::memcmp(header.magic, "RWMS", 4) != 0)
+        return false;
+    if (header.version == SAVE_VERSION || header.version == 2) {
+        headerSize = header.version == 2 ? offsetof(SaveHeader, gridBytes) : sizeof(header);
+        if (size < headerSize)
+            return false;
+        std::memcpy(&header, data, headerSize);
+    } else if (header.version != 1) {
+        return false;
+    }
+    if (header.rows <= 0 || header.cols <= 0 ||
+        header.rows > MAX_MAP_DIM || header.cols > MAX_MAP_DIM)
+        return false;
+
+    std::size_t cells = static_cast<std::size_t>(header.rows) * header.cols;
+    // Older versions store the tiles raw.
+    bool encoded = header.version == SAVE_VERSION;
+    std::size_t gridBytes = encoded ? header.gridBytes : cells;
+    // Entity counts and the encoded grid are bounded by the cell count, so
+    // this cannot overflow.
+    if (header.enemyCount > cells || header.powerupCount > cells || gridBytes > cells)
+        return false;
+    std::size_t expected = headerSize + padded(gridBytes) +
+                           8 * (static_cast<std::size_t>(header.enemyCount) + header.powerupCount) + 4;
+    if (size != expected)
+        return false;
+    std::uint32_t storedCrc;
+    std::memcpy(&storedCrc, data + size - 4, sizeof(storedCrc));
+    if (crc32(data, size - 4) != storedCrc)
+        return false;
+
+    const unsigned char *tiles = data + headerSize;
+    std::vector<unsigned char> decoded;
+    if (encoded) {
+        decoded.resize(cells);
+        if (!decodeTiles(tiles, gridBytes, decoded.data(), cells))
+            return false;
+    } else {
+        for (std::size_t i = 0; i < cells; i++) {
+            if (tiles[i] > static_cast<unsigned char>(Tile::Exit))
+                return false;
+        }
+    }
+    const unsigned char *entities = tiles + padded(gridBytes);
+    std::size_t entityCount = header.enemyCount + static_cast<std::size_t>(header.powerupCount);
+    Position player = {header.playerX, header.playerY};
+    Position exit = {header.exitX, header.exitY};
+    if (!inBounds(player, header.rows, header.cols) || !inBounds(exit, header.rows, header.cols))
+        return false;
+    for (std::size_t i = 0; i < entityCount; i++) {
+        std::int32_t xy[2];
+        std::memcpy(xy, entities + 8 * i, sizeof(xy));
+        if (!inBounds(Position{xy[0], xy[1]}, header.rows, header.cols))
+            return false;
+    }
+
+    game.grid.load(header.rows, header.cols, encoded ? decoded.data() : tiles);
+    game.level = header.level;
+    game.score = header.score;
+    game.moveCounter = header.moveCounter;
+    game.totalMoves = header.totalMoves;
+    game.enemyDelay = header.enemyDelay;
+    game.gameOver = header.gameOver != 0;
+    game.pursuit = header.pursuit == static_cast<std::int32_t>(PursuitMode::FlowField)
+                       ? PursuitMode::FlowField : PursuitMode::Greedy;
+    game.player.pos = player;
+    game.exitPos = exit;
+    if (header.version >= 2)
+        game.rng.setState(header.rngState[0] | static_cast<std::uint64_t>(header.rngState[1]) << 32,
+                          header.rngInc[0] | static_cast<std::uint64_t>(header.rngInc[1]) << 32);
+
+    game.enemies.resize(header.enemyCount);
+    for (std::uint32_t i = 0; i < header.enemyCount; i++) {
+        std::int32_t xy[2];
+        std::memcpy(xy, entities + 8 * i, sizeof(xy));
+        game.enemies.set(i, Position{xy[0], xy[1]});
+    }
+    const unsigned char *powerups = entities + 8 * static_cast<std::size_t>(header.enemyCount);
+    game.powerups.resize(header.powerupCount);
+    for (std::uint32_t i = 0; i < header.powerupCount; i++) {
+        std::int32_t xy[2];
+        std::memcpy(xy, powerups + 8 * i, sizeof(xy));
+        game.powerups[i] = {xy[0], xy[1]};
+    }
+    rebuildOccupancy(game);
+    return true;
+}
+
+// Save game state to a binary file.
+bool saveGameBinary(const Game &game, const std::string &filename) {
+    std::vector<unsigned char> image;
+    serializeGame(game, image);
+    if (!writeFileAtomic(filename, image.data(), image.size())) {
+        std::cout << "Error writing save file." << std::endl;
+        return false;
+    }
+    std::cout << "Game saved to " << filename << std::endl;
+    return true;
+}
+
+// Load game state from a binary file by mapping it into memory.
+bool loadGameBinary(Game &game, const std::string &filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cout << "Error opening file for loading." << std::endl;
+        return false;
+    }
+    if (!deserializeGame(game, file.data(), file.size())) {
+        std::cout << "Corrupt or incompatible save file." << std::endl;
+        return false;
+    }
+    std::cout << "Game loaded from " << filename << std::endl;
+    return true;
+}
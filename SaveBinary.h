@@ -0,0 +1,59 @@
+#ifndef SAVEBINARY_H
+#define SAVEBINARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Game;
+struct GameSnapshot;
+
+// Binary save format (version 3), integers in native byte order (the
+// structs are copied as they are, so saves move only between machines of
+// the same endianness):
+//   header    SaveHeader (magic "RWMS", version, dimensions, counters,
+//             generator state, grid blob size); version 2 headers stop
+//             before gridBytes and version 1 headers before rngState
+//   grid      gridBytes of run-length encoded tiles in row-major order,
+//             zero-padded to a multiple of 4. Each run is one byte, the
+//             tile in the low 2 bits and the length minus 1 in the high 6;
+//             a length field of 63 is followed by a varint holding the
+//             length minus 64. Versions 1 and 2 store rows * cols raw
+//             tile bytes instead.
+//   enemies   enemyCount   x { int32 x, int32 y }
+//   powerups  powerupCount x { int32 x, int32 y }
+//   trailer   uint32 CRC-32 of every preceding byte
+const std::uint32_t SAVE_VERSION = 3;
+
+struct SaveHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::int32_t rows, cols;
+    std::int32_t level, score, moveCounter, totalMoves, enemyDelay;
+    std::int32_t gameOver, pursuit;
+    std::int32_t playerX, playerY;
+    std::int32_t exitX, exitY;
+    std::uint32_t enemyCount, powerupCount;
+    std::uint32_t rngState[2], rngInc[2];  // Low word first.
+    std::uint32_t gridBytes;               // Encoded grid, before padding.
+};
+
+// CRC-32 (IEEE) of a byte range; pass a previous result to continue it.
+std::uint32_t crc32(const void *data, std::size_t size, std::uint32_t crc = 0);
+
+// Encode a game into the binary format, replacing the buffer contents.
+void serializeGame(const Game &game, std::vector<unsigned char> &out);
+// The same for a snapshot; loading the image gives back the snapshot's game.
+void serializeSnapshot(const GameSnapshot &snapshot, std::vector<unsigned char> &out);
+
+// Decode a binary image into a game. Fails without touching the game if
+// the image is truncated, corrupt or out of bounds.
+bool deserializeGame(Game &game, const unsigned char *data, std::size_t size);
+
+// Binary counterparts of saveGame/loadGame. Saving replaces the file
+// atomically (see writeFileAtomic); loading maps it.
+bool saveGameBinary(const Game &game, const std::string &filename);
+bool loadGameBinary(Game &game, const std::string &filename);
+
+#endif  // SAVEBINARY_H
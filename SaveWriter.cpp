@@ -0,0 +1,77 @@
+#include "SaveWriter.h"
+#include "Metrics.h"
+#include "SaveBinary.h"
+#include "Utils.h"
+
+SaveWriter::SaveWriter(std::size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1), stopping_(false) {
+    worker_ = std::thread(&SaveWriter::workerLoop, this);
+}
+
+SaveWriter::~SaveWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+bool SaveWriter::submit(const Game &game, const std::string &path) {
+    std::uint64_t now = monotonicNs();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= capacity_)
+            return false;
+        queue_.emplace_back();
+        Job &job = queue_.back();
+        takeSnapshot(game, job.snapshot);
+        job.result.path = path;
+        job.submitted = now;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+bool SaveWriter::poll(SaveResult &result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_.empty())
+        return false;
+    result = finished_.front().result;
+    finished_.pop_front();
+    return true;
+}
+
+void SaveWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty(); });
+}
+
+std::size_t SaveWriter::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void SaveWriter::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty())
+            return;  // Stopping, with nothing left to write.
+
+        // Nothing but the worker touches the front job until it moves to
+        // finished_, and deque references survive pushes at the back.
+        Job &job = queue_.front();
+        lock.unlock();
+        serializeSnapshot(job.snapshot, image_);
+        job.result.ok = writeFileAtomic(job.result.path, image_.data(), image_.size());
+        job.result.bytes = job.result.ok ? image_.size() : 0;
+        job.result.ms = static_cast<double>(monotonicNs() - job.submitted) / 1e6;
+        lock.lock();
+
+        finished_.push_back(std::move(job));
+        queue_.pop_front();
+        if (queue_.empty())
+            idle_.notify_all();
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef SAVEWRITER_H
+#define SAVEWRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Snapshot.h"
+
+// Outcome of one background save.
+struct SaveResult {
+    std::string path;
+    bool ok;
+    std::size_t bytes;  // Size of the file written.
+    double ms;          // Time from submit() until the file was in place.
+
+    SaveResult() : ok(false), bytes(0), ms(0.0) {}
+};
+
+// Writes binary saves on a thread of its own. submit() only takes a
+// snapshot of the game, which shares the maze instead of copying it, so
+// the game loop never waits for encoding or the disk. The writer encodes
+// the image (SaveBinary.h) and replaces the file with writeFileAtomic().
+//
+// Finished jobs are handed back through poll(), and their snapshots are
+// released there: the game thread is the only one that changes a grid, so
+// it must also be the one that drops the shared references to it.
+class SaveWriter {
+public:
+    // At most capacity saves wait to be written at a time.
+    explicit SaveWriter(std::size_t capacity = 4);
+    // Writes everything still queued before returning.
+    ~SaveWriter();
+
+    // Queue a save of the game to path. Returns false without blocking if
+    // the queue is full.
+    bool submit(const Game &game, const std::string &path);
+
+    // Take the oldest finished save, if any.
+    bool poll(SaveResult &result);
+
+    // Wait until every queued save has been written.
+    void flush();
+
+    // Saves queued or being written.
+    std::size_t pending() const;
+
+private:
+    SaveWriter(const SaveWriter &);
+    SaveWriter &operator=(const SaveWriter &);
+
+    struct Job {
+        GameSnapshot snapshot;
+        SaveResult result;
+        std::uint64_t submitted;
+    };
+
+    void workerLoop();
+
+    std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<Job> queue_;     // Waiting; the front one is being written.
+    std::deque<Job> finished_;  // Written, waiting for poll().
+    std::vector<unsigned char> image_;  // Worker's encode buffer.
+    bool stopping_;
+    std::thread worker_;
+};
+
+#endif  // SAVEWRITER_H
@@ -0,0 +1,114 @@
+#include "Snapshot.h"
+
+GameSnapshot::GameSnapshot()
+    : player{0, 0}, exitPos{0, 0}, score(0), moveCounter(0), totalMoves(0), enemyDelay(1),
+      level(1), gameOver(false), pursuit(PursuitMode::Greedy), lastPowerupId(-1) {}
+
+void takeSnapshot(const Game &game, GameSnapshot &snapshot) {
+    snapshot.grid = game.grid;
+    snapshot.player = game.player.pos;
+    snapshot.exitPos = game.exitPos;
+    snapshot.enemies = game.enemies;
+    snapshot.powerups = game.powerups;
+    snapshot.score = game.score;
+    snapshot.moveCounter = game.moveCounter;
+    snapshot.totalMoves = game.totalMoves;
+    snapshot.enemyDelay = game.enemyDelay;
+    snapshot.level = game.level;
+    snapshot.gameOver = game.gameOver;
+    snapshot.pursuit = game.pursuit;
+    snapshot.lastPowerupId = game.lastPowerupId;
+    snapshot.rng = game.rng;
+}
+
+void restoreSnapshot(Game &game, const GameSnapshot &snapshot) {
+    // Same maze: take the current entities out of the occupancy index and
+    // put the snapshot's in. Otherwise the index is rebuilt for the new one.
+    bool sameMaze = game.grid.sharesCellsWith(snapshot.grid) &&
+                    game.pursuit == snapshot.pursuit;
+    if (sameMaze) {
+        for (std::size_t i = 0; i < game.enemies.size(); i++)
+            game.occupancy.removeEnemy(game.enemies[i]);
+        for (const Position &p : game.powerups)
+            game.occupancy.clearPowerup(p);
+    } else {
+        game.grid = snapshot.grid;
+    }
+
+    game.player.pos = snapshot.player;
+    game.exitPos = snapshot.exitPos;
+    game.enemies = snapshot.enemies;
+    game.powerups = snapshot.powerups;
+    game.score = snapshot.score;
+    game.moveCounter = snapshot.moveCounter;
+    game.totalMoves = snapshot.totalMoves;
+    game.enemyDelay = snapshot.enemyDelay;
+    game.level = snapshot.level;
+    game.gameOver = snapshot.gameOver;
+    game.pursuit = snapshot.pursuit;
+    game.lastPowerupId = snapshot.lastPowerupId;
+    game.rng = snapshot.rng;
+
+    if (sameMaze) {
+        for (std::size_t i = 0; i < game.enemies.size(); i++)
+            game.occupancy.addEnemy(game.enemies[i]);
+        for (std::size_t i = 0; i < game.powerups.size(); i++)
+            game.occupancy.setPowerup(game.powerups[i], static_cast<int>(i));
+        game.nextEnemies.resize(game.enemies.size());
+    } else {
+        rebuildOccupancy(game);
+    }
+}
+
+// Rewind buffer
+
+RewindBuffer::RewindBuffer(std::size_t capacity)
+    : slots_((capacity > 0 ? capacity : 1) + 1), next_(0), count_(0) {}
+
+void RewindBuffer::push(const Game &game) {
+    stage(game);
+    commit();
+}
+
+void RewindBuffer::stage(const Game &game) {
+    // The spare slot keeps the oldest entry intact until commit().
+    takeSnapshot(game, slots_[next_]);
+}
+
+void RewindBuffer::commit() {
+    next_ = (next_ + 1) % slots_.size();
+    if (count_ < capacity())
+        count_++;
+}
+
+std::size_t RewindBuffer::rewind(Game &game, std::size_t steps) {
+    if (steps > count_)
+        steps = count_;
+    if (steps == 0)
+        return 0;
+    next_ = (next_ + slots_.size() - steps) % slots_.size();
+    count_ -= steps;
+    restoreSnapshot(game, slots_[next_]);
+    return steps;
+}
+
+// Save slots
+
+void SaveSlots::store(const std::string &name, const Game &game) {
+    takeSnapshot(game, slots_[name]);
+}
+
+bool SaveSlots::restore(const std::string &name, Game &game) const {
+    auto it = slots_.find(name);
+    if (it == slots_.end())
+        return false;
+    restoreSnapshot(game, it->second);
+    return true;
+}
+
+std::vector<std::string> SaveSlots::names() const {
+    std::vector<std::string> result;
+    for (const auto &slot : slots_)
+        result.push_back(slot.first);
+    return result;
+}
@@ -0,0 +1,80 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "Game.h"
+
+// In-memory copy of a game's state. The maze is held as a copy-on-write
+// Grid, which shares its buffers with the game, so taking a snapshot copies
+// only the entities and counters: O(entities), never O(cells).
+struct GameSnapshot {
+    Grid grid;
+    Position player;
+    Position exitPos;
+    EnemyList enemies;
+    std::vector<Position> powerups;
+    int score;
+    int moveCounter;
+    int totalMoves;
+    int enemyDelay;
+    int level;
+    bool gameOver;
+    PursuitMode pursuit;
+    int lastPowerupId;
+    Rng rng;
+
+    GameSnapshot();
+};
+
+// Copy the game's state into snapshot, reusing the snapshot's buffers.
+void takeSnapshot(const Game &game, GameSnapshot &snapshot);
+
+// Put the game back into a snapshot's state. Within the same maze this
+// costs O(entities): the occupancy index is patched rather than rebuilt.
+void restoreSnapshot(Game &game, const GameSnapshot &snapshot);
+
+// Bounded history of snapshots for rewinding move by move. Once full, each
+// push overwrites the oldest entry, reusing its buffers.
+class RewindBuffer {
+public:
+    explicit RewindBuffer(std::size_t capacity = 64);
+
+    // Remember the game's current state (call before applying a move).
+    void push(const Game &game);
+
+    // push() in two halves: stage() snapshots the game into a spare slot
+    // and commit() adds that snapshot to the history. A move that turns out
+    // to change nothing is simply not committed.
+    void stage(const Game &game);
+    void commit();
+
+    // Step back up to steps pushed states, restoring the oldest one
+    // reached; returns how many steps were taken back.
+    std::size_t rewind(Game &game, std::size_t steps = 1);
+
+    std::size_t size() const { return count_; }
+    std::size_t capacity() const { return slots_.size() - 1; }
+    void clear() { count_ = 0; }
+
+private:
+    std::vector<GameSnapshot> slots_;  // One more than the capacity, for stage().
+    std::size_t next_;   // Slot the next push writes.
+    std::size_t count_;  // Valid entries, newest just before next_.
+};
+
+// Named in-memory save slots.
+class SaveSlots {
+public:
+    void store(const std::string &name, const Game &game);
+    // Returns false if no slot has that name.
+    bool restore(const std::string &name, Game &game) const;
+    std::vector<std::string> names() const;
+
+private:
+    std::map<std::string, GameSnapshot> slots_;
+};
+
+#endif  // SNAPSHOT_H
@@ -0,0 +1,349 @@
+#include "Solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <queue>
+#include <unordered_set>
+
+SolverOptions::SolverOptions() : collectPowerups(true), maxNodes(1000000) {}
+
+SolverResult::SolverResult()
+    : solved(false), limitReached(false), powerups(0), nodesExpanded(0),
+      nodesGenerated(0), seconds(0.0) {}
+
+namespace {
+
+// Powerups beyond this many are not tracked in a state's bit mask.
+const int MAX_TRACKED_POWERUPS = 64;
+
+// Memory for the per-player-cell fields of flow-field pursuit. Small maps
+// keep a field for every cell; on large ones the least recently used field
+// is rebuilt for the new cell.
+const std::size_t FIELD_CACHE_BYTES = std::size_t(64) << 20;
+
+// One search state. Its enemy cells live in Search::enemyCells_.
+struct Node {
+    int parent;          // Previous state, or -1 for the start.
+    int g;               // Moves from the start.
+    int cell;            // Player cell index.
+    int moveCounter;     // Game::moveCounter after the move.
+    std::uint64_t mask;  // Tracked powerups collected so far.
+    Action action;       // Move that led here.
+    bool closed;         // Already expanded.
+};
+
+struct OpenEntry {
+    int f, g, node;
+};
+
+// Lowest f first; on ties prefer the deeper node, which is closer to a goal.
+struct OpenOrder {
+    bool operator()(const OpenEntry &a, const OpenEntry &b) const {
+        return a.f != b.f ? a.f > b.f : a.g < b.g;
+    }
+};
+
+class Search {
+public:
+    Search(const Game &game, const SolverOptions &options);
+
+    void run(SolverResult &result);
+
+    std::size_t hashOf(int node) const;
+    bool sameState(int a, int b) const;
+
+private:
+    struct StateHash {
+        const Search *search;
+        std::size_t operator()(int node) const { return search->hashOf(node); }
+    };
+    struct StateEqual {
+        const Search *search;
+        bool operator()(int a, int b) const { return search->sameState(a, b); }
+    };
+
+    Position cellPos(int cell) const { return Position{cell / cols_, cell % cols_}; }
+    int heuristic(int cell, std::uint64_t mask) const;
+    bool enemyOn(int node, int cell) const;
+    void predictEnemies(int from, int to, int playerCell);
+    const FlowField &fieldFor(int cell);
+    void expand(int node);
+
+    const Game &game_;
+    const Grid &grid_;
+    int cols_;
+    std::size_t enemyCount_;
+    int exitCell_;
+    std::uint64_t required_;
+    FlowField exitField_;
+    std::vector<FlowField> targetFields_;         // One per tracked powerup.
+    std::vector<int> targetToExit_;               // Maze distance powerup -> exit.
+    std::vector<int> powerupBit_;                 // Per cell: tracked bit or -1.
+    std::vector<FlowField> fields_;     // Flow-field pursuit: cached fields.
+    std::vector<int> fieldCell_;        // Player cell each cached field leads to.
+    std::vector<long long> fieldUsed_;  // When each cached field was last used.
+    std::vector<int> fieldSlot_;        // Per cell: index into fields_, or -1.
+    std::size_t fieldCapacity_;
+    long long fieldClock_;
+
+    std::vector<Node> nodes_;
+    std::vector<int> enemyCells_;  // enemyCount_ sorted cells per node.
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, OpenOrder> open_;
+    std::unordered_set<int, StateHash, StateEqual> seen_;
+    long long maxNodes_;
+    long long expanded_;
+};
+
+Search::Search(const Game &game, const SolverOptions &options)
+    : game_(game), grid_(game.grid), cols_(game.grid.cols()),
+      enemyCount_(game.enemies.size()), exitCell_(game.grid.index(game.exitPos.x, game.exitPos.y)),
+      required_(0), powerupBit_(game.grid.size(), -1),
+      fieldCapacity_(0), fieldClock_(0), seen_(1024, StateHash{this}, StateEqual{this}),
+      maxNodes_(options.maxNodes), expanded_(0) {
+    exitField_.build(grid_, game.exitPos);
+    if (options.collectPowerups) {
+        // Only powerups reachable from the player become goals.
+        FlowField fromPlayer;
+        fromPlayer.build(grid_, game.player.pos);
+        for (const Position &p : game.powerups) {
+            if (static_cast<int>(targetFields_.size()) == MAX_TRACKED_POWERUPS)
+                break;
+            if (fromPlayer.distance(p) < 0 || exitField_.distance(p) < 0)
+                continue;
+            int bit = static_cast<int>(targetFields_.size());
+            targetFields_.push_back(FlowField());
+            targetFields_.back().build(grid_, p);
+            targetToExit_.push_back(exitField_.distance(p));
+            powerupBit_[grid_.index(p.x, p.y)] = bit;
+            required_ |= std::uint64_t(1) << bit;
+        }
+    }
+    if (game.pursuit == PursuitMode::FlowField) {
+        // A field holds a distance and a queue entry per cell.
+        std::size_t cells = grid_.size();
+        std::size_t perField = 2 * sizeof(int) * cells;
+        fieldCapacity_ = std::max<std::size_t>(1, std::min(cells, FIELD_CACHE_BYTES / perField));
+        fields_.reserve(fieldCapacity_);
+        fieldSlot_.assign(cells, -1);
+    }
+}
+
+std::size_t Search::hashOf(int node) const {
+    const Node &n = nodes_[node];
+    std::uint64_t h = static_cast<std::uint64_t>(n.cell) * 0x9e3779b97f4a7c15ULL;
+    h ^= n.mask + 0x632be59bd9b4e019ULL + (h << 6) + (h >> 2);
+    h ^= static_cast<std::uint64_t>(n.moveCounter) + (h << 6) + (h >> 2);
+    const int *e = &enemyCells_[node * enemyCount_];
+    for (std::size_t i = 0; i < enemyCount_; i++)
+        h = (h ^ static_cast<std::uint64_t>(e[i])) * 0x100000001b3ULL;
+    return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+bool Search::sameState(int a, int b) const {
+    const Node &na = nodes_[a];
+    const Node &nb = nodes_[b];
+    if (na.cell != nb.cell || na.mask != nb.mask || na.moveCounter != nb.moveCounter)
+        return false;
+    return std::equal(enemyCells_.begin() + a * enemyCount_,
+                      enemyCells_.begin() + (a + 1) * enemyCount_,
+                      enemyCells_.begin() + b * enemyCount_);
+}
+
+// Static maze distance to the exit through the farthest powerup still to
+// collect. Never overestimates, and changes by at most one per move.
+int Search::heuristic(int cell, std::uint64_t mask) const {
+    Position pos = cellPos(cell);
+    int h = exitField_.distance(pos);
+    for (std::size_t k = 0; k < targetFields_.size(); k++) {
+        if (!(mask >> k & 1))
+            h = std::max(h, targetFields_[k].distance(pos) + targetToExit_[k]);
+    }
+    return h;
+}
+
+bool Search::enemyOn(int node, int cell) const {
+    const int *e = &enemyCells_[node * enemyCount_];
+    return std::binary_search(e, e + enemyCount_, cell);
+}
+
+const FlowField &Search::fieldFor(int cell) {
+    int slot = fieldSlot_[cell];
+    if (slot < 0) {
+        if (fields_.size() < fieldCapacity_) {
+            slot = static_cast<int>(fields_.size());
+            fields_.push_back(FlowField());
+            fieldCell_.push_back(cell);
+            fieldUsed_.push_back(0);
+        } else {
+            // Misses cost a BFS over the maze, so the scan is cheap beside it.
+            slot = static_cast<int>(std::min_element(fieldUsed_.begin(), fieldUsed_.end()) -
+                                    fieldUsed_.begin());
+            fieldSlot_[fieldCell_[slot]] = -1;
+            fieldCell_[slot] = cell;
+        }
+        fieldSlot_[cell] = slot;
+        fields_[slot].build(grid_, cellPos(cell));
+    }
+    fieldUsed_[slot] = ++fieldClock_;
+    return fields_[slot];
+}
+
+// Move the enemies of node `from` into node `to`, as moveEnemies() would
+// with the player on playerCell.
+void Search::predictEnemies(int from, int to, int playerCell) {
+    Position player = cellPos(playerCell);
+    const FlowField *field = game_.pursuit == PursuitMode::FlowField ? &fieldFor(playerCell) : nullptr;
+    for (std::size_t i = 0; i < enemyCount_; i++) {
+        Position pos = cellPos(enemyCells_[from * enemyCount_ + i]);
+        Position next;
+        if (field && field->distance(pos) > 0)
+            next = field->step(pos);
+        else
+            next = calculateEnemyMove(pos, player, grid_);
+        enemyCells_[to * enemyCount_ + i] = grid_.index(next.x, next.y);
+    }
+    std::sort(enemyCells_.begin() + to * enemyCount_, enemyCells_.begin() + (to + 1) * enemyCount_);
+}
+
+void Search::expand(int node) {
+    static const Action ACTIONS[4] = {Action::Up, Action::Down, Action::Left, Action::Right};
+    static const int DX[4] = {-1, 1, 0, 0};
+    static const int DY[4] = {0, 0, -1, 1};
+
+    Node current = nodes_[node];
+    Position pos = cellPos(current.cell);
+    for (int a = 0; a < 4; a++) {
+        Position next = {pos.x + DX[a], pos.y + DY[a]};
+        // Bumping into a wall changes nothing, so it is never worth a move.
+        if (!isValidMove(next, grid_))
+            continue;
+        int cell = grid_.index(next.x, next.y);
+        // Walking into an enemy is a catch.
+        if (enemyOn(node, cell))
+            continue;
+        std::uint64_t mask = current.mask;
+        if (powerupBit_[cell] >= 0)
+            mask |= std::uint64_t(1) << powerupBit_[cell];
+        // The level ends on the exit, so it cannot be crossed early.
+        if (cell == exitCell_ && (mask & required_) != required_)
+            continue;
+
+        // Build the candidate in the next slot, then keep or drop it.
+        int child = static_cast<int>(nodes_.size());
+        Node n = {node, current.g + 1, cell, current.moveCounter + 1, mask, ACTIONS[a], false};
+        enemyCells_.resize(enemyCells_.size() + enemyCount_);
+        if (n.moveCounter >= game_.enemyDelay) {
+            predictEnemies(node, child, cell);
+            n.moveCounter = 0;
+        } else {
+            std::copy(enemyCells_.begin() + node * enemyCount_,
+                      enemyCells_.begin() + (node + 1) * enemyCount_,
+                      enemyCells_.begin() + child * enemyCount_);
+        }
+        nodes_.push_back(n);
+        if (enemyOn(child, cell)) {
+            nodes_.pop_back();
+            enemyCells_.resize(enemyCells_.size() - enemyCount_);
+            continue;
+        }
+
+        auto found = seen_.find(child);
+        if (found != seen_.end()) {
+            Node &old = nodes_[*found];
+            if (!old.closed && n.g < old.g) {
+                // Shorter route to a waiting state: reroute it.
+                old.parent = node;
+                old.g = n.g;
+                old.action = n.action;
+                open_.push(OpenEntry{n.g + heuristic(cell, mask), n.g, *found});
+            }
+            nodes_.pop_back();
+            enemyCells_.resize(enemyCells_.size() - enemyCount_);
+            continue;
+        }
+        seen_.insert(child);
+        open_.push(OpenEntry{n.g + heuristic(cell, mask), n.g, child});
+    }
+}
+
+void Search::run(SolverResult &result) {
+    if (game_.gameOver || exitField_.distance(game_.player.pos) < 0)
+        return;
+
+    Node start = {-1, 0, grid_.index(game_.player.pos.x, game_.player.pos.y),
+                  game_.moveCounter, 0, Action::None, false};
+    nodes_.push_back(start);
+    for (std::size_t i = 0; i < enemyCount_; i++) {
+        Position e = game_.enemies[i];
+        enemyCells_.push_back(grid_.index(e.x, e.y));
+    }
+    std::sort(enemyCells_.begin(), enemyCells_.end());
+    seen_.insert(0);
+    open_.push(OpenEntry{heuristic(start.cell, 0), 0, 0});
+
+    int goal = -1;
+    while (!open_.empty()) {
+        OpenEntry entry = open_.top();
+        open_.pop();
+        Node &node = nodes_[entry.node];
+        if (node.closed || entry.g != node.g)
+            continue;  // Stale entry for a rerouted state.
+        if (node.cell == exitCell_) {
+            goal = entry.node;
+            break;
+        }
+        if (expanded_ >= maxNodes_) {
+            result.limitReached = true;
+            break;
+        }
+        node.closed = true;
+        expanded_++;
+        expand(entry.node);
+    }
+
+    result.nodesExpanded = expanded_;
+    result.nodesGenerated = static_cast<long long>(nodes_.size());
+    if (goal < 0)
+        return;
+    result.solved = true;
+    for (int n = goal; nodes_[n].parent >= 0; n = nodes_[n].parent)
+        result.actions.push_back(nodes_[n].action);
+    std::reverse(result.actions.begin(), result.actions.end());
+}
+
+}  // namespace
+
+SolverResult solveLevel(const Game &game, const SolverOptions &options) {
+    SolverResult result;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Search search(game, options);
+        search.run(result);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Count pickups by replaying the plan.
+    if (result.solved) {
+        Game copy = game;
+        copy.enemyUpdater = nullptr;
+        copy.metrics = nullptr;
+        for (Action action : result.actions) {
+            if (stepGame(copy, action) & STEP_POWERUP)
+                result.powerups++;
+        }
+    }
+    return result;
+}
+
+bool checkSolution(const Game &game, const std::vector<Action> &actions) {
+    Game copy = game;
+    copy.enemyUpdater = nullptr;
+    copy.metrics = nullptr;
+    int outcome = STEP_IGNORED;
+    for (Action action : actions) {
+        outcome = stepGame(copy, action);
+        if (outcome & (STEP_CAUGHT | STEP_EXIT))
+            break;
+    }
+    return (outcome & STEP_EXIT) && !(outcome & STEP_CAUGHT);
+}
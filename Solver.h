@@ -0,0 +1,42 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <vector>
+#include "Game.h"
+
+// Limits for solveLevel().
+struct SolverOptions {
+    bool collectPowerups;   // Pick up every reachable powerup before the exit.
+    long long maxNodes;     // Give up after expanding this many states.
+
+    SolverOptions();
+};
+
+// Outcome of a search.
+struct SolverResult {
+    bool solved;                  // actions reach the exit safely.
+    bool limitReached;            // Stopped at maxNodes rather than exhausting the space.
+    std::vector<Action> actions;  // Moves from the given state to the exit.
+    int powerups;                 // Powerups collected along the way.
+    long long nodesExpanded;
+    long long nodesGenerated;
+    double seconds;
+
+    SolverResult();
+    double nodesPerSecond() const { return seconds > 0 ? nodesExpanded / seconds : 0.0; }
+};
+
+// Plan a sequence of moves that takes the player from its current cell to
+// the exit without being caught, visiting every reachable powerup first if
+// asked to. A* over (player cell, enemy cells, collected powerups, move
+// counter); enemy moves are predicted with the same rules as stepGame()
+// using the serial update, so replaying the actions through stepGame()
+// reproduces the search. The heuristic is the static maze distance through
+// the farthest remaining powerup to the exit. Solutions are shortest.
+SolverResult solveLevel(const Game &game, const SolverOptions &options = SolverOptions());
+
+// Replay actions on a copy of game through stepGame(); true if they end on
+// the exit without the player being caught.
+bool checkSolution(const Game &game, const std::vector<Action> &actions);
+
+#endif  // SOLVER_H
@@ -0,0 +1,130 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads)
+    : job_(nullptr), jobSize_(0), generation_(0), pending_(0), stopping_(false) {
+    if (threads <= 0)
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0)
+        threads = 1;
+    for (int i = 1; i < threads; i++)
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+}
+
+void ThreadPool::runChunk(int index) {
+    std::size_t chunks = static_cast<std::size_t>(size());
+    std::size_t begin = jobSize_ * index / chunks;
+    std::size_t end = jobSize_ * (index + 1) / chunks;
+    if (begin < end)
+        (*job_)(begin, end);
+}
+
+void ThreadPool::workerLoop(int index) {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_)
+                return;
+            seen = generation_;
+        }
+        runChunk(index);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0)
+                done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t n, RangeFn fn) {
+    if (workers_.empty() || n < 2) {
+        if (n > 0)
+            fn(0, n);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        jobSize_ = n;
+        pending_ = static_cast<int>(workers_.size());
+        generation_++;
+    }
+    wake_.notify_all();
+    runChunk(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+namespace {
+
+// Items [begin, end) not yet claimed by a thread.
+struct Share {
+    std::mutex mutex;
+    std::size_t begin, end;
+};
+
+}  // namespace
+
+void ThreadPool::parallelForStealing(std::size_t n, std::size_t grain, RangeFn fn) {
+    if (grain == 0)
+        grain = 1;
+    std::size_t count = static_cast<std::size_t>(size());
+    std::vector<Share> shares(count);
+    for (std::size_t i = 0; i < count; i++) {
+        shares[i].begin = n * i / count;
+        shares[i].end = n * (i + 1) / count;
+    }
+
+    auto work = [&](std::size_t self) {
+        Share &own = shares[self];
+        while (true) {
+            std::size_t begin = 0, end = 0;
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.begin < own.end) {
+                    begin = own.begin;
+                    end = std::min(own.end, begin + grain);
+                    own.begin = end;
+                }
+            }
+            if (begin < end) {
+                fn(begin, end);
+                continue;
+            }
+            // Out of work: take the back half of the first non-empty share.
+            for (std::size_t k = 1; k < count && begin == end; k++) {
+                Share &victim = shares[(self + k) % count];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                std::size_t left = victim.end - victim.begin;
+                if (left > 0) {
+                    end = victim.end;
+                    begin = victim.end - (left + 1) / 2;
+                    victim.end = begin;
+                }
+            }
+            if (begin == end)
+                return;  // Every item has been claimed.
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = begin;
+            own.end = end;
+        }
+    };
+    // One participant per share.
+    parallelFor(count, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++)
+            work(i);
+    });
+}
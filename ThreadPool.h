@@ -0,0 +1,70 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Non-owning reference to a callable taking (begin, end). Unlike
+// std::function it never allocates, so parallel loops can run on the tick
+// path; the callable must outlive the call it is passed to.
+class RangeFn {
+public:
+    template <typename Fn,
+              typename = typename std::enable_if<!std::is_same<Fn, RangeFn>::value>::type>
+    RangeFn(const Fn &fn) : object_(&fn), call_(&invoke<Fn>) {}
+
+    void operator()(std::size_t begin, std::size_t end) const { call_(object_, begin, end); }
+
+private:
+    template <typename Fn>
+    static void invoke(const void *object, std::size_t begin, std::size_t end) {
+        (*static_cast<const Fn *>(object))(begin, end);
+    }
+
+    const void *object_;
+    void (*call_)(const void *, std::size_t, std::size_t);
+};
+
+// Fixed set of worker threads for data-parallel loops. The calling thread
+// takes part in every loop, so a pool of size 1 runs everything inline.
+class ThreadPool {
+public:
+    // threads counts the caller too; 0 means one per hardware thread.
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // Split [0, n) into size() contiguous chunks and run fn(begin, end) on
+    // each chunk in parallel; returns when every chunk is done.
+    void parallelFor(std::size_t n, RangeFn fn);
+
+    // Like parallelFor(), but for items of very uneven cost: fn(begin, end)
+    // gets batches of at most grain items. Each thread starts on its own
+    // contiguous share and, once that runs out, steals the back half of
+    // another thread's remaining share.
+    void parallelForStealing(std::size_t n, std::size_t grain, RangeFn fn);
+
+private:
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    void workerLoop(int index);
+    void runChunk(int index);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const RangeFn *job_;
+    std::size_t jobSize_;
+    unsigned long generation_;
+    int pending_;
+    bool stopping_;
+};
+
+#endif  // THREADPOOL_H
@@ -1,8 +1,22 @@
 #include "Utils.h"
+#include "Input.h"
+#include <cstdio>
+
+// Inside a TerminalSession the terminal is already raw, so just take the
+// next queued key. Returns 0 once input has ended.
+static char nextQueuedKey() {
+    InputQueue &queue = inputQueue();
+    while (queue.empty() && !queue.eof())
+        queue.poll(-1);
+    return queue.pop();
+}
 
 #ifdef _WIN32
     #include <conio.h>
+    #include <windows.h>
     char getInputChar() {
+        if (TerminalSession::current())
+            return nextQueuedKey();
         return _getch();
     }
 #else
@@ -10,6 +24,8 @@
     #include <termios.h>
     #include <cstdio>
     char getInputChar() {
+        if (TerminalSession::current())
+            return nextQueuedKey();
         char buf = 0;
         struct termios old = {0};
         if(tcgetattr(0, &old) < 0)
@@ -30,3 +46,68 @@
     }
 #endif
 
+
+#ifdef _WIN32
+    bool writeFileAtomic(const std::string &path, const void *data, std::size_t size) {
+        std::string tmp = path + ".tmp";
+        FILE *f = fopen(tmp.c_str(), "wb");
+        if (!f)
+            return false;
+        bool ok = fwrite(data, 1, size, f) == size && fflush(f) == 0;
+        ok = (fclose(f) == 0) && ok;
+        if (ok && !MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+            ok = false;
+        if (!ok)
+            remove(tmp.c_str());
+        return ok;
+    }
+#else
+    #include <fcntl.h>
+    bool writeFileAtomic(const std::string &path, const void *data, std::size_t size) {
+        std::string tmp = path + ".tmp";
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+        const char *p = static_cast<const char *>(data);
+        bool ok = true;
+        while (size > 0) {
+            ssize_t n = write(fd, p, size);
+            if (n < 0) {
+                ok = false;
+                break;
+            }
+            p += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        ok = ok && fsync(fd) == 0;
+        ok = (close(fd) == 0) && ok;
+        if (ok && rename(tmp.c_str(), path.c_str()) != 0)
+            ok = false;
+        if (!ok)
+            unlink(tmp.c_str());
+        return ok;
+    }
+#endif
+
+#ifdef _WIN32
+    void terminalSize(int &rows, int &cols) {
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        rows = 24;
+        cols = 80;
+        if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+            rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+            cols = info.srWindow.Right - info.srWindow.Left + 1;
+        }
+    }
+#else
+    #include <sys/ioctl.h>
+    void terminalSize(int &rows, int &cols) {
+        struct winsize ws;
+        rows = 24;
+        cols = 80;
+        if (ioctl(1, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+            rows = ws.ws_row;
+            cols = ws.ws_col;
+        }
+    }
+#endif
@@ -1,9 +1,34 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstddef>
+#include <string>
+
+// ANSI color codes. Plain character arrays, so streaming one never builds
+// a std::string.
+const char *const RESET   = "\033[0m";
+const char *const RED     = "\033[1;31m";
+const char *const GREEN   = "\033[1;32m";
+const char *const YELLOW  = "\033[1;33m";
+const char *const BLUE    = "\033[1;34m";
+const char *const MAGENTA = "\033[1;35m";
+
+// Background colors.
+const char *const BG_WHITE = "\033[47m";
+const char *const BG_GRAY  = "\033[100m";
+
 // Returns a single character from input without waiting for Enter.
 // On Windows it uses conio.h (_getch()) while on Unix systems it sets the terminal to raw mode.
+// While a TerminalSession is open it reads from the session's input queue
+// instead and returns 0 at end of input.
 char getInputChar();
 
+// Size of the terminal in character cells; 24x80 if it cannot be queried.
+void terminalSize(int &rows, int &cols);
+
+// Replace a file's contents atomically: write to a temporary file, flush it
+// to disk and rename it over the target. Returns false on any failure.
+bool writeFileAtomic(const std::string &path, const void *data, std::size_t size);
+
 #endif  // UTILS_H
 
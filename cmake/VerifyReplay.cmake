@@ -0,0 +1,22 @@
+# Records a short turn-based session from scripted keys, then re-simulates
+# it with --verify; fails if either run fails. Run with cmake -P and
+# -DGAME=<runwithmind binary> -DWORK_DIR=<scratch directory>.
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${WORK_DIR}/keys.txt" "ddddssssddddssssaawwddssddss")
+
+execute_process(COMMAND "${GAME}" --seed 7 --record session.rwr
+                WORKING_DIRECTORY "${WORK_DIR}"
+                INPUT_FILE "${WORK_DIR}/keys.txt"
+                OUTPUT_QUIET
+                RESULT_VARIABLE status)
+if(NOT status EQUAL 0 OR NOT EXISTS "${WORK_DIR}/session.rwr")
+    message(FATAL_ERROR "Recording a session failed (${status})")
+endif()
+
+execute_process(COMMAND "${GAME}" --verify session.rwr
+                WORKING_DIRECTORY "${WORK_DIR}"
+                RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "--verify failed (${status})")
+endif()
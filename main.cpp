@@ -1,14 +1,256 @@
 #include "Game.h"
+#include "AllocationCounter.h"
+#include "Difficulty.h"
+#include "LevelAnalysis.h"
+#include "LevelGenerator.h"
+#include "LevelPack.h"
+#include "Replay.h"
+#include "Solver.h"
 #include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <cstring>
 #include <iostream>
 
-int main() {
-    srand(static_cast<unsigned int>(time(NULL)));
+static void usage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --flow-field     enemies chase along BFS shortest paths\n"
+              << "  --seed N         seed for level generation\n"
+              << "  --size RxC       maze rows and columns (default 20x20, up to 4096x4096)\n"
+              << "  --realtime HZ    enemies move on a clock at HZ ticks per second\n"
+              << "  --fps N          redraw limit in real-time mode (default 30)\n"
+              << "  --pack FILE      play the levels of a level pack (from --level, default 1)\n"
+              << "  --record FILE    record the session to a replay file\n"
+              << "  --replay FILE    step through a recorded replay\n"
+              << "  --verify FILE    re-simulate a replay and check its final state\n"
+              << "  --generate N     generate N validated maps and report throughput\n"
+              << "  --solve N        generate N maps and solve each with the autoplay agent\n"
+              << "  --estimate N     simulate N games per policy and report win rate and score\n"
+              << "  --policy P       policy for --estimate: random, greedy, solver or all (default all)\n"
+              << "  --analyze N      generate N maps and report static path and safety metrics\n"
+              << "  --min-margin M   safety margin a map needs to pass --analyze\n"
+              << "  --level L        level to generate (default 1)\n"
+              << "  --threads T      worker threads for batch modes (default: all cores)\n";
+}
+
+// Batch-generate maps and print throughput and rejection statistics.
+static int runGenerate(int count, int level, const SessionOptions &options, int threads) {
+    std::vector<Game> maps;
+    BatchStats stats = generateLevels(maps, count, level, options.seed, threads, 1000,
+                                      options.rows, options.cols);
+    std::cout << "Generated " << stats.maps << " level-" << level << " maps in "
+              << stats.seconds * 1000.0 << " ms on " << stats.threads << " threads ("
+              << static_cast<long long>(stats.mapsPerSecond()) << " maps/s)\n"
+              << "Attempts: " << stats.attempts << ", rejection rate: "
+              << stats.rejectionRate() * 100.0 << "%, fallbacks: " << stats.fallbacks
+              << std::endl;
+    return 0;
+}
+
+// Generate maps, solve each one and check the plans against stepGame().
+static int runSolve(int count, int level, const SessionOptions &options, int threads) {
+    std::vector<Game> maps;
+    generateLevels(maps, count, level, options.seed, threads, 1000, options.rows, options.cols);
+    int solved = 0, invalid = 0, limitHits = 0;
+    long long nodes = 0, moves = 0;
+    double seconds = 0.0;
+    for (Game &game : maps) {
+        game.pursuit = options.pursuit;
+        prepareTickScratch(game);
+        SolverResult result = solveLevel(game);
+        nodes += result.nodesExpanded;
+        seconds += result.seconds;
+        if (!result.solved) {
+            if (result.limitReached)
+                limitHits++;
+            continue;
+        }
+        solved++;
+        moves += static_cast<long long>(result.actions.size());
+        if (!checkSolution(game, result.actions))
+            invalid++;
+    }
+    std::cout << "Solved " << solved << " of " << count << " level-" << level << " maps";
+    if (solved > 0)
+        std::cout << ", mean solution length " << static_cast<double>(moves) / solved << " moves";
+    // A search that ran out of nodes says nothing about the map itself.
+    if (solved < count)
+        std::cout << "\nUnsolved: " << limitHits << " hit the node limit, "
+                  << count - solved - limitHits << " have no safe path";
+    std::cout << "\nExpanded " << nodes << " nodes in " << seconds * 1000.0 << " ms ("
+              << static_cast<long long>(seconds > 0 ? nodes / seconds : 0.0) << " nodes/s)";
+    if (invalid > 0)
+        std::cout << "\n" << invalid << " plans failed when replayed through stepGame";
+    std::cout << std::endl;
+    return invalid == 0 && solved == count ? 0 : 1;
+}
+
+// Simulate games with each requested policy and print the estimates.
+static int runEstimate(int count, int level, const SessionOptions &options, int threads,
+                       const std::string &policy) {
+    const Policy POLICIES[3] = {Policy::Random, Policy::Greedy, Policy::Solver};
+    EstimateOptions estimate;
+    estimate.level = level;
+    estimate.games = count;
+    estimate.baseSeed = options.seed;
+    estimate.pursuit = options.pursuit;
+    estimate.rows = options.rows;
+    estimate.cols = options.cols;
+    estimate.threads = threads;
+    for (Policy p : POLICIES) {
+        if (policy != "all" && policy != policyName(p))
+            continue;
+        estimate.policy = p;
+        Estimate e = estimateDifficulty(estimate);
+        std::cout << policyName(p) << ": " << e.games << " level-" << level << " games in "
+                  << e.seconds * 1000.0 << " ms on " << e.threads << " threads ("
+                  << static_cast<long long>(e.gamesPerSecond()) << " games/s)\n"
+                  << "  win rate " << e.winRate.mean * 100.0 << "% [" << e.winRate.low * 100.0
+                  << ", " << e.winRate.high * 100.0 << "], timeouts " << e.timeouts << "\n"
+                  << "  score " << e.score.mean << " [" << e.score.low << ", " << e.score.high
+                  << "], moves " << e.moves.mean << " [" << e.moves.low << ", " << e.moves.high
+                  << "]" << std::endl;
+    }
+    return 0;
+}
+
+// Generate maps and run the static analyzer over them.
+static int runAnalyze(int count, int level, const SessionOptions &options, int threads,
+                      const AnalysisLimits &limits) {
+    std::vector<Game> maps;
+    generateLevels(maps, count, level, options.seed, threads, 1000, options.rows, options.cols);
+    LevelAnalyzer analyzer;
+    int passed = 0, reachable = 0;
+    long long pathTotal = 0, marginTotal = 0, marginCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Game &game : maps) {
+        const LevelAnalysis &a = analyzer.analyze(game);
+        if (passesAnalysis(a, limits))
+            passed++;
+        if (a.pathLength < 0)
+            continue;
+        reachable++;
+        pathTotal += a.pathLength;
+        if (a.safetyMargin != NO_THREAT) {
+            marginTotal += a.safetyMargin;
+            marginCount++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Analyzed " << maps.size() << " level-" << level << " maps in "
+              << seconds * 1e6 / std::max<std::size_t>(maps.size(), 1) << " us/map\n"
+              << "Mean path length " << (reachable ? static_cast<double>(pathTotal) / reachable : 0.0)
+              << ", mean safety margin "
+              << (marginCount ? static_cast<double>(marginTotal) / marginCount : 0.0) << "\n"
+              << passed << " of " << maps.size() << " pass";
+    if (limits.minSafetyMargin > -NO_THREAT)
+        std::cout << " (safety margin >= " << limits.minSafetyMargin << ")";
+    std::cout << std::endl;
+    return 0;
+}
+
+// In builds that count allocations, report ticks that allocated and turn
+// them into a failing exit status.
+static int checkTickAllocations(int status) {
+    if (!allocationCountingEnabled())
+        return status;
+    std::cout << allocatingTicks() << " ticks allocated (" << totalAllocations()
+              << " allocations in total)" << std::endl;
+    return allocatingTicks() > 0 ? 1 : status;
+}
+
+int main(int argc, char *argv[]) {
+    SessionOptions options;
+    options.seed = static_cast<unsigned int>(time(NULL));
+    int generateCount = 0;
+    int solveCount = 0;
+    int estimateCount = 0;
+    std::string policy = "all";
+    int analyzeCount = 0;
+    AnalysisLimits limits;
+    int level = 1;
+    int threads = 0;
+    std::string packPath;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--flow-field") == 0) {
+            options.pursuit = PursuitMode::FlowField;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue &&
+                   std::sscanf(argv[i + 1], "%dx%d", &options.rows, &options.cols) == 2) {
+            i++;
+        } else if (std::strcmp(argv[i], "--realtime") == 0 && hasValue) {
+            options.tickRate = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--fps") == 0 && hasValue) {
+            options.frameRate = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--pack") == 0 && hasValue) {
+            packPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+            viewReplay(argv[++i]);
+            return 0;
+        } else if (std::strcmp(argv[i], "--verify") == 0 && hasValue) {
+            return checkTickAllocations(verifyReplay(argv[++i]) ? 0 : 1);
+        } else if (std::strcmp(argv[i], "--generate") == 0 && hasValue) {
+            generateCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--solve") == 0 && hasValue) {
+            solveCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--estimate") == 0 && hasValue) {
+            estimateCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--policy") == 0 && hasValue) {
+            Policy parsed;
+            policy = argv[++i];
+            if (policy != "all" && !parsePolicy(policy, parsed)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--analyze") == 0 && hasValue) {
+            analyzeCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-margin") == 0 && hasValue) {
+            limits.minSafetyMargin = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--level") == 0 && hasValue) {
+            level = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = std::atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (generateCount > 0)
+        return runGenerate(generateCount, level, options, threads);
+    if (analyzeCount > 0)
+        return runAnalyze(analyzeCount, level, options, threads, limits);
+    if (estimateCount > 0)
+        return checkTickAllocations(runEstimate(estimateCount, level, options, threads, policy));
+    if (solveCount > 0)
+        return checkTickAllocations(runSolve(solveCount, level, options, threads));
+
+    LevelPack pack;
+    if (!packPath.empty()) {
+        if (!pack.open(packPath)) {
+            std::cout << "Cannot open level pack " << packPath << std::endl;
+            return 1;
+        }
+        if (level < 1 || level > pack.count()) {
+            std::cout << packPath << " has levels 1 to " << pack.count() << std::endl;
+            return 1;
+        }
+        options.pack = &pack;
+        options.packStart = level - 1;
+    }
+
     char choice;
     do {
-        runGame();
+        runGame(options);
+        // Each new game gets a fresh maze; only the first one is recorded.
+        options.seed++;
+        options.recordPath.clear();
         std::cout << "Play Again? (Y/N): ";
         std::cin >> choice;
         std::cin.ignore();
@@ -17,4 +259,3 @@ int main() {
     std::cout << "Thank you for playing!" << std::endl;
     return 0;
 }
-